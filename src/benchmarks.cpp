@@ -0,0 +1,120 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+//  benchmarks.cpp
+//
+// Timing comparisons for data structures in this repository, which are not run as part
+// of the tests
+//
+
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <tuple>
+#include <functional>
+
+#include "structures/union_find.hpp"
+#include "structures/single_linkage.hpp"
+
+using namespace std;
+using namespace structures;
+
+// returns the fastest of several runs of a function in milliseconds
+double time_ms(const function<void()>& run, size_t num_runs) {
+    double fastest = numeric_limits<double>::max();
+    for (size_t k = 0; k < num_runs; k++) {
+        auto start = chrono::steady_clock::now();
+        run();
+        auto stop = chrono::steady_clock::now();
+        fastest = min(fastest, chrono::duration<double, milli>(stop - start).count());
+    }
+    return fastest;
+}
+
+// Kruskal's algorithm as it would be written without single_linkage: sort every edge
+// and then union along them in order
+size_t plain_kruskal(size_t num_vertices, vector<WeightedEdge<double>> edges,
+                     size_t num_clusters, double max_weight) {
+    sort(edges.begin(), edges.end(), [](const WeightedEdge<double>& a, const WeightedEdge<double>& b) {
+        return make_tuple(a.weight, a.first, a.second) < make_tuple(b.weight, b.first, b.second);
+    });
+    UnionFind union_find(num_vertices);
+    for (const WeightedEdge<double>& edge : edges) {
+        if (union_find.num_groups() <= num_clusters || edge.weight > max_weight) {
+            break;
+        }
+        union_find.union_groups(edge.first, edge.second);
+    }
+    return union_find.num_groups();
+}
+
+void benchmark_single_linkage() {
+    
+    size_t num_vertices = 1000000;
+    size_t num_edges = 5000000;
+    size_t num_runs = 3;
+    
+    default_random_engine gen(17);
+    uniform_int_distribution<size_t> vertex_distr(0, num_vertices - 1);
+    uniform_real_distribution<double> weight_distr(0.0, 1.0);
+    vector<WeightedEdge<double>> edges(num_edges);
+    for (WeightedEdge<double>& edge : edges) {
+        edge = WeightedEdge<double>{vertex_distr(gen), vertex_distr(gen), weight_distr(gen)};
+    }
+    
+    cout << "single linkage on " << num_vertices << " vertices and " << num_edges
+         << " random edges, fastest of " << num_runs << " runs in ms" << endl;
+    
+    double inf = numeric_limits<double>::infinity();
+    vector<tuple<string, size_t, double, size_t>> configurations {
+        make_tuple("k = 1", 1, inf, 1),
+        make_tuple("k = 1000", 1000, inf, 1),
+        make_tuple("threshold 0.2", 1, 0.2, 1),
+        make_tuple("k = 1, 4 threads", 1, inf, 4)
+    };
+    for (const auto& configuration : configurations) {
+        size_t num_clusters = get<1>(configuration);
+        double max_weight = get<2>(configuration);
+        size_t num_threads = get<3>(configuration);
+        size_t plain_groups = 0;
+        size_t engine_groups = 0;
+        double plain_time = time_ms([&]() {
+            plain_groups = plain_kruskal(num_vertices, edges, num_clusters, max_weight);
+        }, num_runs);
+        double engine_time = time_ms([&]() {
+            engine_groups = single_linkage(num_vertices, edges, num_clusters, max_weight,
+                                           num_threads).clusters.num_groups();
+        }, num_runs);
+        if (plain_groups != engine_groups) {
+            cerr << "error: single linkage found " << engine_groups << " clusters but the plain loop found "
+                 << plain_groups << " with " << get<0>(configuration) << endl;
+            exit(1);
+        }
+        cout << get<0>(configuration) << "\tplain sort and union: " << plain_time
+             << "\tsingle_linkage: " << engine_time << endl;
+    }
+}
+
+int main(void) {
+    
+    benchmark_single_linkage();
+    
+    return 0;
+}
@@ -0,0 +1,117 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "structures/concurrent_union_find.hpp"
+
+namespace structures {
+
+using namespace std;
+
+ConcurrentUnionFind::ConcurrentUnionFind(size_t size) : parents(size), sizes(size) {
+    for (size_t i = 0; i < size; i++) {
+        parents[i].store(i);
+        sizes[i].store(1);
+    }
+}
+
+ConcurrentUnionFind::~ConcurrentUnionFind() {
+    // nothing to do
+}
+
+size_t ConcurrentUnionFind::size() const {
+    return parents.size();
+}
+
+size_t ConcurrentUnionFind::find_group(size_t i) {
+    while (true) {
+        size_t parent = parents[i].load();
+        if (parent == i) {
+            return i;
+        }
+        size_t grandparent = parents[parent].load();
+        if (grandparent != parent) {
+            // split the path by pointing to the grandparent, unless another thread has
+            // already moved this index somewhere else
+            parents[i].compare_exchange_weak(parent, grandparent);
+        }
+        i = parent;
+    }
+}
+
+void ConcurrentUnionFind::union_groups(size_t i, size_t j) {
+    while (true) {
+        size_t head_i = find_group(i);
+        size_t head_j = find_group(j);
+        if (head_i == head_j) {
+            // the indices are already in the same group
+            return;
+        }
+        // link the lower priority head below the higher one
+        if (priority(head_i) < priority(head_j)) {
+            swap(head_i, head_j);
+        }
+        size_t expected = head_j;
+        if (parents[head_j].compare_exchange_strong(expected, head_i)) {
+            // collect the linked group's size now that no more will be deposited there
+            size_t amount = sizes[head_j].exchange(0);
+            if (amount != 0) {
+                deposit_size(head_i, amount);
+            }
+            return;
+        }
+        // another thread linked head j first, so try again from the new heads
+    }
+}
+
+void ConcurrentUnionFind::deposit_size(size_t head, size_t amount) {
+    while (true) {
+        sizes[head].fetch_add(amount);
+        if (parents[head].load() == head) {
+            // whoever links this head later will collect the amount
+            return;
+        }
+        // the head was linked before we deposited, so we might have missed the collection
+        amount = sizes[head].exchange(0);
+        if (amount == 0) {
+            // someone else already passed it along
+            return;
+        }
+        head = find_group(head);
+    }
+}
+
+bool ConcurrentUnionFind::same_group(size_t i, size_t j) {
+    while (true) {
+        size_t head_i = find_group(i);
+        size_t head_j = find_group(j);
+        if (head_i == head_j) {
+            return true;
+        }
+        if (parents[head_i].load() == head_i) {
+            // head i was still a head after we found head j, so they were distinct groups
+            // at that moment
+            return false;
+        }
+    }
+}
+
+size_t ConcurrentUnionFind::group_size(size_t i) {
+    return sizes[find_group(i)].load();
+}
+
+}
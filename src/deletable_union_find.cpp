@@ -0,0 +1,145 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "structures/deletable_union_find.hpp"
+
+namespace structures {
+
+using namespace std;
+
+DeletableUnionFind::DeletableUnionFind(size_t size) : nodes(size), node_of(size), reps(size), live_sizes(size, 1),
+                                                      next_members(size), prev_members(size), num_ghosts(0) {
+    for (size_t i = 0; i < size; i++) {
+        node_of[i] = i;
+        reps[i] = i;
+        next_members[i] = i;
+        prev_members[i] = i;
+    }
+}
+
+DeletableUnionFind::~DeletableUnionFind() {
+    // nothing to do
+}
+
+size_t DeletableUnionFind::size() const {
+    return node_of.size();
+}
+
+size_t DeletableUnionFind::find_group(size_t i) {
+    return reps[nodes.find_group(node_of[i])];
+}
+
+void DeletableUnionFind::union_groups(size_t i, size_t j) {
+    size_t head_i = nodes.find_group(node_of[i]);
+    size_t head_j = nodes.find_group(node_of[j]);
+    if (head_i == head_j) {
+        // the indices are already in the same group
+        return;
+    }
+    
+    size_t rep = reps[head_i];
+    size_t live_size = live_sizes[head_i] + live_sizes[head_j];
+    nodes.union_groups(head_i, head_j);
+    size_t head = nodes.find_group(head_i);
+    reps[head] = rep;
+    live_sizes[head] = live_size;
+    
+    // exchanging successors splices the two circular member lists into one
+    size_t next_i = next_members[i];
+    size_t next_j = next_members[j];
+    next_members[i] = next_j;
+    prev_members[next_j] = i;
+    next_members[j] = next_i;
+    prev_members[next_i] = j;
+}
+
+void DeletableUnionFind::isolate(size_t i) {
+    size_t head = nodes.find_group(node_of[i]);
+    if (live_sizes[head] == 1) {
+        // the index is already by itself
+        return;
+    }
+    
+    // unlink the index from its group's members
+    size_t next = next_members[i];
+    size_t prev = prev_members[i];
+    next_members[prev] = next;
+    prev_members[next] = prev;
+    next_members[i] = i;
+    prev_members[i] = i;
+    if (reps[head] == i) {
+        reps[head] = next;
+    }
+    live_sizes[head]--;
+    
+    // leave the old node behind to hold the group together, and move to a new one
+    node_of[i] = nodes.add_element();
+    reps.push_back(i);
+    live_sizes.push_back(1);
+    num_ghosts++;
+    
+    if (num_ghosts > node_of.size()) {
+        rebuild();
+    }
+}
+
+size_t DeletableUnionFind::group_size(size_t i) {
+    return live_sizes[nodes.find_group(node_of[i])];
+}
+
+vector<size_t> DeletableUnionFind::group(size_t i) const {
+    vector<size_t> to_return;
+    // walk around the circular list of members
+    size_t curr = i;
+    do {
+        to_return.push_back(curr);
+        curr = next_members[curr];
+    } while (curr != i);
+    return to_return;
+}
+
+void DeletableUnionFind::rebuild() {
+    
+    // the member lists already describe the groups, so we only need the representatives
+    vector<bool> is_rep(node_of.size());
+    for (size_t i = 0; i < node_of.size(); i++) {
+        is_rep[i] = (reps[nodes.find_group(node_of[i])] == i);
+    }
+    
+    nodes = UnionFind(node_of.size());
+    reps.resize(node_of.size());
+    live_sizes.resize(node_of.size());
+    for (size_t i = 0; i < node_of.size(); i++) {
+        node_of[i] = i;
+    }
+    for (size_t i = 0; i < node_of.size(); i++) {
+        if (is_rep[i]) {
+            size_t live_size = 1;
+            for (size_t curr = next_members[i]; curr != i; curr = next_members[curr]) {
+                nodes.union_groups(i, curr);
+                live_size++;
+            }
+            size_t head = nodes.find_group(i);
+            reps[head] = i;
+            live_sizes[head] = live_size;
+        }
+    }
+    num_ghosts = 0;
+}
+
+}
@@ -0,0 +1,180 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+//  annotated_union_find.hpp
+//
+// Contains a template implementation of a union-find that maintains an aggregate value
+// for each group
+//
+
+#ifndef structures_annotated_union_find_hpp
+#define structures_annotated_union_find_hpp
+
+#include <vector>
+#include <functional>
+#include <utility>
+
+#include "structures/union_find.hpp"
+
+namespace structures {
+
+using namespace std;
+
+
+/*
+ * A UnionFind that maintains an annotation for each group, such as a sum, a minimum, or
+ * a bounding box. Each index begins with its own annotation, and the annotations of two
+ * groups are combined when they are merged, so the annotation of a group can be read in
+ * the time of a find rather than a scan of the group. The combine operation should be
+ * associative and commutative, since the order that groups are merged in is up to the
+ * caller.
+ */
+template <typename T, typename Combine = plus<T>>
+class AnnotatedUnionFind {
+public:
+    
+    /// Construct AnnotatedUnionFind for this many indices, each with the same annotation
+    AnnotatedUnionFind(size_t size = 0, const T& annotation = T(), const Combine& combine = Combine());
+    
+    /// Construct AnnotatedUnionFind with an index for each of these annotations
+    AnnotatedUnionFind(const vector<T>& annotations, const Combine& combine = Combine());
+    ~AnnotatedUnionFind() = default;
+    
+    /// Returns the number of indices in the AnnotatedUnionFind
+    size_t size();
+    
+    /// Adds a new index in a group by itself with an annotation, and returns it
+    size_t add_element(const T& annotation);
+    
+    /// Returns the group ID that index i belongs to (can change after calling union)
+    size_t find_group(size_t i);
+    
+    /// Merges the group containing index i with the group containing index j, and combines
+    /// their annotations
+    void union_groups(size_t i, size_t j);
+    
+    /// Returns the size of the group containing index i
+    size_t group_size(size_t i);
+    
+    /// Returns a copy of the annotation of the group containing index i
+    T group_annotation(size_t i);
+    
+    /// Combines another value into the annotation of the group containing index i
+    void annotate_group(size_t i, const T& annotation);
+    
+    /// Returns a vector of the indices in the same group as index i
+    vector<size_t> group(size_t i);
+    
+    /// Returns all of the groups, each in a separate vector
+    vector<vector<size_t>> all_groups();
+    
+private:
+    
+    /// The groups of the indices
+    UnionFind union_find;
+    
+    /// The annotation of each head's group (not maintained for other indices)
+    vector<T> annotations;
+    
+    Combine combine;
+};
+
+
+
+
+
+
+
+
+
+
+
+
+
+template <typename T, typename Combine>
+AnnotatedUnionFind<T, Combine>::AnnotatedUnionFind(size_t size, const T& annotation, const Combine& combine)
+    : union_find(size), annotations(size, annotation), combine(combine) {
+    // nothing to do
+}
+
+template <typename T, typename Combine>
+AnnotatedUnionFind<T, Combine>::AnnotatedUnionFind(const vector<T>& annotations, const Combine& combine)
+    : union_find(annotations.size()), annotations(annotations), combine(combine) {
+    // nothing to do
+}
+
+template <typename T, typename Combine>
+size_t AnnotatedUnionFind<T, Combine>::size() {
+    return union_find.size();
+}
+
+template <typename T, typename Combine>
+size_t AnnotatedUnionFind<T, Combine>::add_element(const T& annotation) {
+    annotations.push_back(annotation);
+    return union_find.add_element();
+}
+
+template <typename T, typename Combine>
+size_t AnnotatedUnionFind<T, Combine>::find_group(size_t i) {
+    return union_find.find_group(i);
+}
+
+template <typename T, typename Combine>
+void AnnotatedUnionFind<T, Combine>::union_groups(size_t i, size_t j) {
+    size_t head_i = union_find.find_group(i);
+    size_t head_j = union_find.find_group(j);
+    if (head_i == head_j) {
+        // the indices are already in the same group
+        return;
+    }
+    T combined = combine(annotations[head_i], annotations[head_j]);
+    union_find.union_groups(head_i, head_j);
+    // finding from a head is a single step
+    annotations[union_find.find_group(head_i)] = move(combined);
+}
+
+template <typename T, typename Combine>
+size_t AnnotatedUnionFind<T, Combine>::group_size(size_t i) {
+    return union_find.group_size(i);
+}
+
+template <typename T, typename Combine>
+T AnnotatedUnionFind<T, Combine>::group_annotation(size_t i) {
+    return annotations[union_find.find_group(i)];
+}
+
+template <typename T, typename Combine>
+void AnnotatedUnionFind<T, Combine>::annotate_group(size_t i, const T& annotation) {
+    // index rather than hold a reference, since vector<bool> only has proxies for its elements
+    size_t head = union_find.find_group(i);
+    annotations[head] = combine(annotations[head], annotation);
+}
+
+template <typename T, typename Combine>
+vector<size_t> AnnotatedUnionFind<T, Combine>::group(size_t i) {
+    return union_find.group(i);
+}
+
+template <typename T, typename Combine>
+vector<vector<size_t>> AnnotatedUnionFind<T, Combine>::all_groups() {
+    return union_find.all_groups();
+}
+
+}
+
+#endif /* structures_annotated_union_find_hpp */
@@ -0,0 +1,93 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+//  concurrent_union_find.hpp
+//
+// Contains an implementation of a lock-free union-find that can be shared between threads
+//
+
+#ifndef structures_concurrent_union_find_hpp
+#define structures_concurrent_union_find_hpp
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+namespace structures {
+
+using namespace std;
+
+/**
+ * A lock-free Union-Find data structure that supports merging a set of indices in
+ * disjoint sets from many threads at once. Groups are linked by a pseudorandom priority
+ * with compare-and-swap, and finds use wait-free path splitting, following Jayanti and
+ * Tarjan (2016), "A randomized concurrent algorithm for disjoint set union".
+ */
+class ConcurrentUnionFind {
+public:
+    /// Construct ConcurrentUnionFind for this many indices
+    ConcurrentUnionFind(size_t size);
+    
+    /// Destructor
+    ~ConcurrentUnionFind();
+    
+    /// Returns the number of indices in the ConcurrentUnionFind
+    size_t size() const;
+    
+    /// Returns the group ID that index i belongs to (can change after calling union, including
+    /// from another thread)
+    size_t find_group(size_t i);
+    
+    /// Merges the group containing index i with the group containing index j
+    void union_groups(size_t i, size_t j);
+    
+    /// Returns true if indices i and j are in the same group. Unlike comparing the results
+    /// of find_group, this is correct even if there are concurrent unions.
+    bool same_group(size_t i, size_t j);
+    
+    /// Returns the size of the group containing index i. Exact only once the unions that
+    /// affect the group have all returned.
+    size_t group_size(size_t i);
+    
+private:
+    
+    /// Returns the priority used to choose the head when linking two groups
+    inline static uint64_t priority(size_t i);
+    
+    /// Add to the size of a group, passing the amount along if the head is linked under
+    /// another group before it can be collected
+    void deposit_size(size_t head, size_t amount);
+    
+    /// The parent of each index in its group's tree, which is itself for the head
+    vector<atomic<size_t>> parents;
+    
+    /// The size of each head's group, plus amounts that are in transit to a head
+    vector<atomic<size_t>> sizes;
+};
+
+inline uint64_t ConcurrentUnionFind::priority(size_t i) {
+    // a bijective mix of the bits, so that there are no ties
+    uint64_t x = i;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+}
+
+#endif /* structures_concurrent_union_find_hpp */
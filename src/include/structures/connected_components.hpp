@@ -0,0 +1,45 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+//  connected_components.hpp
+//
+// Parallel connected components of a graph given as an edge list
+//
+
+#ifndef structures_connected_components_hpp
+#define structures_connected_components_hpp
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace structures {
+
+using namespace std;
+
+/// Returns the connected component of each vertex in a graph with vertices
+/// 0, 1, ..., num_vertices - 1 and the given undirected edges. Components are labeled
+/// densely as 0, 1, ..., k - 1 in order of their lowest vertex. The edges are divided
+/// between the threads and merged in a shared ConcurrentUnionFind. Every endpoint must be
+/// less than num_vertices.
+vector<size_t> connected_components(size_t num_vertices, const vector<pair<size_t, size_t>>& edges,
+                                    size_t num_threads = 1);
+
+}
+
+#endif /* structures_connected_components_hpp */
@@ -0,0 +1,99 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+//  deletable_union_find.hpp
+//
+// Contains an implementation of a union-find that can remove indices from their groups
+//
+
+#ifndef structures_deletable_union_find_hpp
+#define structures_deletable_union_find_hpp
+
+#include <vector>
+
+#include "structures/union_find.hpp"
+
+namespace structures {
+
+using namespace std;
+
+/**
+ * A Union-Find data structure that can also remove an index from its group, in amortized
+ * nearly constant time. Each index refers to a node of an internal UnionFind, and removing
+ * an index moves it to a new node, leaving its old node behind in the tree as a ghost that
+ * still connects the rest of the group. Once the ghosts outnumber the indices, the nodes
+ * are rebuilt from the groups. The members of each group are kept in a doubly linked list
+ * so that an index can be unlinked without visiting the rest of its group.
+ */
+class DeletableUnionFind {
+public:
+    /// Construct DeletableUnionFind for this many indices
+    DeletableUnionFind(size_t size);
+    
+    /// Destructor
+    ~DeletableUnionFind();
+    
+    /// Returns the number of indices in the DeletableUnionFind
+    size_t size() const;
+    
+    /// Returns the group ID that index i belongs to, which is one of the indices in the
+    /// group (can change after calling union or isolate)
+    size_t find_group(size_t i);
+    
+    /// Merges the group containing index i with the group containing index j
+    void union_groups(size_t i, size_t j);
+    
+    /// Removes index i from its group and puts it in a group by itself
+    void isolate(size_t i);
+    
+    /// Returns the size of the group containing index i
+    size_t group_size(size_t i);
+    
+    /// Returns a vector of the indices in the same group as index i
+    vector<size_t> group(size_t i) const;
+    
+private:
+    
+    /// Replace the nodes with one node per index, discarding the ghosts
+    void rebuild();
+    
+    /// The groups of the nodes, including ghosts
+    UnionFind nodes;
+    
+    /// The current node of each index
+    vector<size_t> node_of;
+    
+    /// The index that identifies the group of each head node (not maintained for other nodes)
+    vector<size_t> reps;
+    
+    /// The number of indices in the group of each head node (not maintained for other nodes)
+    vector<size_t> live_sizes;
+    
+    /// The next index in a circular list of the members of each index's group
+    vector<size_t> next_members;
+    
+    /// The previous index in a circular list of the members of each index's group
+    vector<size_t> prev_members;
+    
+    /// The number of nodes that no longer belong to an index
+    size_t num_ghosts;
+};
+
+}
+
+#endif /* structures_deletable_union_find_hpp */
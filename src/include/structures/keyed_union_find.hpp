@@ -0,0 +1,262 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+//  keyed_union_find.hpp
+//
+// Contains a template implementation of a union-find over arbitrary hashable keys
+//
+
+#ifndef structures_keyed_union_find_hpp
+#define structures_keyed_union_find_hpp
+
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <cassert>
+
+#include "structures/union_find.hpp"
+
+namespace structures {
+
+using namespace std;
+
+
+/*
+ * A UnionFind whose elements are keys rather than dense indices. Keys are added the first
+ * time they are seen, and they are mapped to indices by an open addressing hash table
+ * that stores each key's index and hash, so that a lookup usually takes a single probe
+ * without comparing keys.
+ */
+template <typename Key, typename Hash = hash<Key>, typename KeyEqual = equal_to<Key>>
+class KeyedUnionFind {
+public:
+    
+    /// Initialize an empty KeyedUnionFind
+    KeyedUnionFind();
+    ~KeyedUnionFind() = default;
+    
+    /// Returns the number of keys in the KeyedUnionFind
+    size_t size();
+    
+    /// Allocates space for this many keys in total
+    void reserve(size_t size);
+    
+    /// Adds a key in a group by itself if it is not already present, and returns its index
+    size_t insert(const Key& key);
+    
+    /// Returns true if the key has been added, else false
+    bool contains(const Key& key) const;
+    
+    /// Returns a copy of the key that identifies the group of a key (can change after calling
+    /// union). The key must already be present.
+    Key find_group(const Key& key);
+    
+    /// Merges the group containing one key with the group containing another, adding
+    /// either key if it is not already present
+    void union_groups(const Key& key_1, const Key& key_2);
+    
+    /// Returns the size of the group containing a key, which must already be present
+    size_t group_size(const Key& key);
+    
+    /// Returns a vector of the keys in the same group as a key, which must already be present
+    vector<Key> group(const Key& key);
+    
+    /// Returns all of the groups, each in a separate vector
+    vector<vector<Key>> all_groups();
+    
+private:
+    
+    /// A slot in the hash table
+    struct Slot {
+        /// The index of the key in this slot, or -1 if it is empty
+        size_t index;
+        /// The hash of the key in this slot
+        size_t hash;
+    };
+    
+    /// Returns the hash of a key, with its bits mixed so that hashers that are the identity
+    /// still spread keys over the table
+    inline size_t hash_key(const Key& key) const;
+    
+    /// Returns the slot that contains the key, or the empty slot where it belongs
+    inline size_t probe(const Key& key, size_t key_hash) const;
+    
+    /// Returns the index of a key, which must already be present
+    inline size_t index_of(const Key& key) const;
+    
+    /// Move the slots into a new table with this many slots
+    void rehash(size_t capacity);
+    
+    /// The groups of the key indices
+    UnionFind union_find;
+    
+    /// The key at each index
+    vector<Key> keys;
+    
+    /// Open addressing table with linear probing, which has a power of 2 size and is at most
+    /// half full
+    vector<Slot> slots;
+    
+    Hash hasher;
+    KeyEqual key_equal;
+};
+
+
+
+
+
+
+
+
+
+
+
+
+
+template <typename Key, typename Hash, typename KeyEqual>
+KeyedUnionFind<Key, Hash, KeyEqual>::KeyedUnionFind() : slots(16, Slot{size_t(-1), 0}) {
+    // nothing to do
+}
+
+template <typename Key, typename Hash, typename KeyEqual>
+size_t KeyedUnionFind<Key, Hash, KeyEqual>::size() {
+    return keys.size();
+}
+
+template <typename Key, typename Hash, typename KeyEqual>
+void KeyedUnionFind<Key, Hash, KeyEqual>::reserve(size_t size) {
+    union_find.reserve(size);
+    keys.reserve(size);
+    size_t capacity = slots.size();
+    while (capacity < 2 * size) {
+        capacity *= 2;
+    }
+    if (capacity > slots.size()) {
+        rehash(capacity);
+    }
+}
+
+template <typename Key, typename Hash, typename KeyEqual>
+inline size_t KeyedUnionFind<Key, Hash, KeyEqual>::hash_key(const Key& key) const {
+    uint64_t x = hasher(key);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+template <typename Key, typename Hash, typename KeyEqual>
+inline size_t KeyedUnionFind<Key, Hash, KeyEqual>::probe(const Key& key, size_t key_hash) const {
+    size_t mask = slots.size() - 1;
+    size_t s = key_hash & mask;
+    while (slots[s].index != size_t(-1)) {
+        // only compare keys if the hashes match
+        if (slots[s].hash == key_hash && key_equal(keys[slots[s].index], key)) {
+            break;
+        }
+        s = (s + 1) & mask;
+    }
+    return s;
+}
+
+template <typename Key, typename Hash, typename KeyEqual>
+inline size_t KeyedUnionFind<Key, Hash, KeyEqual>::index_of(const Key& key) const {
+    size_t index = slots[probe(key, hash_key(key))].index;
+    assert(index != size_t(-1));
+    return index;
+}
+
+template <typename Key, typename Hash, typename KeyEqual>
+void KeyedUnionFind<Key, Hash, KeyEqual>::rehash(size_t capacity) {
+    vector<Slot> old_slots(capacity, Slot{size_t(-1), 0});
+    swap(slots, old_slots);
+    size_t mask = slots.size() - 1;
+    for (const Slot& slot : old_slots) {
+        if (slot.index != size_t(-1)) {
+            // the keys are distinct, so we only need to find an empty slot
+            size_t s = slot.hash & mask;
+            while (slots[s].index != size_t(-1)) {
+                s = (s + 1) & mask;
+            }
+            slots[s] = slot;
+        }
+    }
+}
+
+template <typename Key, typename Hash, typename KeyEqual>
+size_t KeyedUnionFind<Key, Hash, KeyEqual>::insert(const Key& key) {
+    size_t key_hash = hash_key(key);
+    size_t s = probe(key, key_hash);
+    if (slots[s].index != size_t(-1)) {
+        return slots[s].index;
+    }
+    
+    size_t index = union_find.add_element();
+    keys.push_back(key);
+    slots[s] = Slot{index, key_hash};
+    if (2 * keys.size() > slots.size()) {
+        rehash(2 * slots.size());
+    }
+    return index;
+}
+
+template <typename Key, typename Hash, typename KeyEqual>
+bool KeyedUnionFind<Key, Hash, KeyEqual>::contains(const Key& key) const {
+    return slots[probe(key, hash_key(key))].index != size_t(-1);
+}
+
+template <typename Key, typename Hash, typename KeyEqual>
+Key KeyedUnionFind<Key, Hash, KeyEqual>::find_group(const Key& key) {
+    return keys[union_find.find_group(index_of(key))];
+}
+
+template <typename Key, typename Hash, typename KeyEqual>
+void KeyedUnionFind<Key, Hash, KeyEqual>::union_groups(const Key& key_1, const Key& key_2) {
+    size_t index_1 = insert(key_1);
+    size_t index_2 = insert(key_2);
+    union_find.union_groups(index_1, index_2);
+}
+
+template <typename Key, typename Hash, typename KeyEqual>
+size_t KeyedUnionFind<Key, Hash, KeyEqual>::group_size(const Key& key) {
+    return union_find.group_size(index_of(key));
+}
+
+template <typename Key, typename Hash, typename KeyEqual>
+vector<Key> KeyedUnionFind<Key, Hash, KeyEqual>::group(const Key& key) {
+    vector<Key> to_return;
+    union_find.for_each_member(index_of(key), [&](size_t i) {
+        to_return.push_back(keys[i]);
+    });
+    return to_return;
+}
+
+template <typename Key, typename Hash, typename KeyEqual>
+vector<vector<Key>> KeyedUnionFind<Key, Hash, KeyEqual>::all_groups() {
+    vector<vector<Key>> to_return;
+    for (const vector<size_t>& index_group : union_find.all_groups()) {
+        to_return.emplace_back();
+        for (size_t i : index_group) {
+            to_return.back().push_back(keys[i]);
+        }
+    }
+    return to_return;
+}
+
+}
+
+#endif /* structures_keyed_union_find_hpp */
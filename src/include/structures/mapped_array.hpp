@@ -0,0 +1,219 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+//  mapped_array.hpp
+//
+// Contains a template implementation of an array that is either owned or backed by a
+// memory mapping
+//
+
+#ifndef structures_mapped_array_hpp
+#define structures_mapped_array_hpp
+
+#include <vector>
+#include <memory>
+#include <utility>
+
+namespace structures {
+
+using namespace std;
+
+
+/*
+ * An array of trivially copyable elements that either owns its elements or refers to
+ * elements inside a private memory mapping, such as one of a file that was mapped
+ * copy-on-write. A mapped array can be written to in place, but it is copied into its
+ * own storage before it is resized, and also when the array is copied so that the copies
+ * do not share elements. The mapping is kept alive until every array that refers to it
+ * is destroyed or resized.
+ */
+template <typename T>
+class MappedArray {
+public:
+    
+    /// Initialize an owned array of this many copies of a value
+    MappedArray(size_t size = 0, const T& value = T());
+    
+    /// Initialize an array that refers to elements inside a mapping
+    MappedArray(T* mapped_elements, size_t size, const shared_ptr<void>& mapping);
+    
+    MappedArray(const MappedArray& other);
+    MappedArray(MappedArray&& other);
+    MappedArray& operator=(const MappedArray& other);
+    MappedArray& operator=(MappedArray&& other);
+    ~MappedArray() = default;
+    
+    inline T& operator[](size_t i);
+    inline const T& operator[](size_t i) const;
+    
+    /// Returns the number of elements
+    inline size_t size() const;
+    
+    /// Returns a pointer to the first element
+    inline T* data();
+    inline const T* data() const;
+    
+    /// Returns true if the elements are inside a mapping
+    bool is_mapped() const;
+    
+    /// Adds an element to the end of the array
+    void push_back(const T& value);
+    
+    /// Allocates space for this many elements in total
+    void reserve(size_t size);
+    
+private:
+    
+    /// Copy mapped elements into owned storage
+    void own();
+    
+    /// The owned elements, which are empty if the array is mapped
+    vector<T> owned;
+    
+    /// The mapping that contains the elements, or null if they are owned
+    shared_ptr<void> mapping;
+    
+    /// The first element, wherever it is stored
+    T* elements;
+    
+    size_t length;
+};
+
+
+
+
+
+
+
+
+
+
+
+
+
+template <typename T>
+MappedArray<T>::MappedArray(size_t size, const T& value) : owned(size, value), elements(owned.data()),
+                                                           length(size) {
+    // nothing to do
+}
+
+template <typename T>
+MappedArray<T>::MappedArray(T* mapped_elements, size_t size, const shared_ptr<void>& mapping)
+    : mapping(mapping), elements(mapped_elements), length(size) {
+    // nothing to do
+}
+
+template <typename T>
+MappedArray<T>::MappedArray(const MappedArray& other) : owned(other.data(), other.data() + other.size()),
+                                                         elements(owned.data()), length(other.size()) {
+    // nothing to do
+}
+
+template <typename T>
+MappedArray<T>::MappedArray(MappedArray&& other) : owned(move(other.owned)), mapping(move(other.mapping)),
+                                                    elements(other.elements), length(other.length) {
+    // moving a vector keeps its buffer, so the element pointer is still valid
+    other.owned.clear();
+    other.elements = other.owned.data();
+    other.length = 0;
+}
+
+template <typename T>
+MappedArray<T>& MappedArray<T>::operator=(const MappedArray& other) {
+    if (this != &other) {
+        owned.assign(other.data(), other.data() + other.size());
+        mapping.reset();
+        elements = owned.data();
+        length = other.size();
+    }
+    return *this;
+}
+
+template <typename T>
+MappedArray<T>& MappedArray<T>::operator=(MappedArray&& other) {
+    if (this != &other) {
+        owned = move(other.owned);
+        mapping = move(other.mapping);
+        elements = other.elements;
+        length = other.length;
+        other.owned.clear();
+        other.elements = other.owned.data();
+        other.length = 0;
+    }
+    return *this;
+}
+
+template <typename T>
+inline T& MappedArray<T>::operator[](size_t i) {
+    return elements[i];
+}
+
+template <typename T>
+inline const T& MappedArray<T>::operator[](size_t i) const {
+    return elements[i];
+}
+
+template <typename T>
+inline size_t MappedArray<T>::size() const {
+    return length;
+}
+
+template <typename T>
+inline T* MappedArray<T>::data() {
+    return elements;
+}
+
+template <typename T>
+inline const T* MappedArray<T>::data() const {
+    return elements;
+}
+
+template <typename T>
+bool MappedArray<T>::is_mapped() const {
+    return mapping.get() != nullptr;
+}
+
+template <typename T>
+void MappedArray<T>::own() {
+    owned.assign(elements, elements + length);
+    mapping.reset();
+    elements = owned.data();
+}
+
+template <typename T>
+void MappedArray<T>::push_back(const T& value) {
+    if (is_mapped()) {
+        own();
+    }
+    owned.push_back(value);
+    elements = owned.data();
+    length++;
+}
+
+template <typename T>
+void MappedArray<T>::reserve(size_t size) {
+    if (is_mapped()) {
+        own();
+    }
+    owned.reserve(size);
+    elements = owned.data();
+}
+
+}
+
+#endif /* structures_mapped_array_hpp */
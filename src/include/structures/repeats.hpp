@@ -0,0 +1,88 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+//  repeats.hpp
+//
+// Detection of tandem repeats, palindromes, and inverted repeats using longest common
+// extension queries on a suffix tree
+//
+
+#ifndef structures_repeats_hpp
+#define structures_repeats_hpp
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+namespace structures {
+
+using namespace std;
+
+/**
+ * A maximal repetition (or run) in a string. The interval [begin, end) has period
+ * period, is at least twice as long as it, and cannot be extended in either direction
+ * without breaking the period. The period is the smallest period of the interval.
+ * Every tandem repeat (or square) in the string is contained in a run whose period
+ * divides the length of the repeated unit.
+ */
+struct Run {
+    size_t begin;
+    size_t end;
+    size_t period;
+};
+
+/**
+ * An inverted repeat in a string. The arm [begin, begin + arm_length) is the reverse
+ * complement of the arm [end - arm_length, end), and the arms are separated by a spacer
+ * of end - begin - 2 * arm_length characters. The arms cannot be extended outward.
+ * A palindrome is an inverted repeat where the complement is the identity, and odd
+ * length palindromes have a spacer of their middle character.
+ */
+struct InvertedRepeat {
+    size_t begin;
+    size_t end;
+    size_t arm_length;
+};
+
+/// Returns all of the runs in a string, ordered by their interval, using O(n log n)
+/// longest common extension queries. Like the other functions here, it builds a suffix tree
+/// over the string and its reverse, which with its extension index takes O(n) words.
+vector<Run> find_runs(const char* begin, const char* end);
+vector<Run> find_runs(const string& str);
+
+/// Returns the maximal palindrome around every center in a string whose arms are at
+/// least a minimum length, ordered by their center.
+vector<InvertedRepeat> find_palindromes(const char* begin, const char* end, size_t min_arm_length = 1);
+vector<InvertedRepeat> find_palindromes(const string& str, size_t min_arm_length = 1);
+
+/// Returns the maximal inverted repeats around every center in a string whose arms are at
+/// least a minimum length and whose spacer is at most a maximum length, ordered by their
+/// center. Repeats that are contained in one with a shorter spacer are not reported. Takes
+/// O(n (s + 1)) time for a maximum spacer length s after building the suffix tree.
+vector<InvertedRepeat> find_inverted_repeats(const char* begin, const char* end,
+                                             const function<char(char)>& complement,
+                                             size_t max_spacer_length = 0, size_t min_arm_length = 1);
+vector<InvertedRepeat> find_inverted_repeats(const string& str, const function<char(char)>& complement,
+                                             size_t max_spacer_length = 0, size_t min_arm_length = 1);
+
+}
+
+
+
+#endif /* structures_repeats_hpp */
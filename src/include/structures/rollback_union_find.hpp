@@ -0,0 +1,100 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+//  rollback_union_find.hpp
+//
+// Contains an implementation of a union-find whose unions can be undone
+//
+
+#ifndef structures_rollback_union_find_hpp
+#define structures_rollback_union_find_hpp
+
+#include <vector>
+#include <cstdint>
+
+namespace structures {
+
+using namespace std;
+
+/**
+ * A Union-Find data structure whose unions can be rolled back to an earlier checkpoint,
+ * for instance during backtracking search or offline dynamic connectivity. Groups are
+ * merged by rank without path compression, so finds take logarithmic time, and rolling
+ * back takes constant time per union that is undone.
+ */
+class RollbackUnionFind {
+public:
+    /// Construct RollbackUnionFind for this many indices
+    RollbackUnionFind(size_t size);
+    
+    /// Destructor
+    ~RollbackUnionFind();
+    
+    /// Returns the number of indices in the RollbackUnionFind
+    size_t size() const;
+    
+    /// Returns the group ID that index i belongs to (can change after calling union or rollback)
+    size_t find_group(size_t i) const;
+    
+    /// Merges the group containing index i with the group containing index j
+    void union_groups(size_t i, size_t j);
+    
+    /// Returns the size of the group containing index i
+    size_t group_size(size_t i) const;
+    
+    /// Returns a vector of the indices in the same group as index i
+    vector<size_t> group(size_t i) const;
+    
+    /// Returns a checkpoint of the current groups that can be rolled back to later
+    size_t checkpoint() const;
+    
+    /// Undoes all of the unions since a checkpoint was taken. Checkpoints taken after
+    /// this one are no longer valid.
+    void rollback_to(size_t checkpoint);
+    
+private:
+    
+    /// A union that can be undone
+    struct Link {
+        /// The head that was linked below the other
+        size_t child;
+        /// The head that remained a head
+        size_t parent;
+        /// Whether the parent's rank was incremented
+        bool rank_increased;
+    };
+    
+    /// The parent of each index in its group's tree, which is itself for the head
+    vector<size_t> parents;
+    
+    /// An upper bound on the height of each head's tree
+    vector<uint8_t> ranks;
+    
+    /// The size of each head's group (not maintained for other indices)
+    vector<size_t> sizes;
+    
+    /// The next index in a circular list of the members of each index's group
+    vector<size_t> next_members;
+    
+    /// Every union that merged two groups, in order
+    vector<Link> links;
+};
+
+}
+
+#endif /* structures_rollback_union_find_hpp */
@@ -0,0 +1,324 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+//  single_linkage.hpp
+//
+// Contains a template implementation of Kruskal's algorithm for single-linkage clustering
+// and minimum spanning forests
+//
+
+#ifndef structures_single_linkage_hpp
+#define structures_single_linkage_hpp
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include "structures/union_find.hpp"
+
+namespace structures {
+
+using namespace std;
+
+/// An undirected edge between two vertices with a weight
+template <typename Weight>
+struct WeightedEdge {
+    size_t first;
+    size_t second;
+    Weight weight;
+};
+
+/// A merge of two clusters in a dendrogram. The vertices are clusters 0, 1, ..., n - 1, and
+/// the cluster formed by the k-th merge is cluster n + k.
+template <typename Weight>
+struct DendrogramMerge {
+    size_t cluster_1;
+    size_t cluster_2;
+    /// The weight of the edge that merged the clusters
+    Weight weight;
+    /// The number of vertices in the merged cluster
+    size_t size;
+};
+
+/**
+ * The result of a single-linkage clustering
+ */
+template <typename Weight>
+struct SingleLinkageClustering {
+    /// The clusters that the vertices ended in
+    UnionFind clusters;
+    /// Each merge, in order of increasing weight
+    vector<DendrogramMerge<Weight>> dendrogram;
+    /// The edge that caused each merge, which together form a minimum spanning forest
+    vector<WeightedEdge<Weight>> spanning_edges;
+};
+
+/// Clusters the vertices 0, 1, ..., num_vertices - 1 by merging along the edges in order of
+/// increasing weight, as in Kruskal's algorithm, and stops once there are num_clusters
+/// clusters or the next edge is heavier than max_weight. By default there is no limit on the
+/// weight, which includes infinite weights if the Weight type has them. Ties in weight are
+/// broken by the vertices, so the result does not depend on the number of threads.
+template <typename Weight>
+SingleLinkageClustering<Weight> single_linkage(size_t num_vertices, vector<WeightedEdge<Weight>> edges,
+                                               size_t num_clusters = 1,
+                                               Weight max_weight = numeric_limits<Weight>::has_infinity
+                                                                   ? numeric_limits<Weight>::infinity()
+                                                                   : numeric_limits<Weight>::max(),
+                                               size_t num_threads = 1);
+
+namespace detail {
+
+/// Sorts a range by sorting contiguous chunks in separate threads and then merging pairs
+/// of adjacent chunks in parallel until one chunk remains. If the comparison is a total
+/// order, the result is the same for any number of threads.
+template <typename Iterator, typename Compare>
+void parallel_sort(Iterator begin, Iterator end, Compare compare, size_t num_threads = 1);
+
+/*
+ * The state of a single-linkage clustering while its edges are processed, which follows the
+ * Filter-Kruskal algorithm of Osipov, Sanders, and Singler (2009). Rather than sorting all of
+ * the edges up front, the edges are partitioned around a pivot weight and the light side is
+ * processed first. Then the heavy edges whose vertices are already clustered together are
+ * filtered out before the heavy side is processed, so that most of them are never sorted.
+ * The edges that remain are still merged in sorted order.
+ */
+template <typename Weight>
+class FilterKruskal {
+public:
+    FilterKruskal(size_t num_vertices, size_t num_clusters, size_t num_threads);
+    ~FilterKruskal() = default;
+    
+    /// Merge along the edges in a range, which may be reordered
+    void process(typename vector<WeightedEdge<Weight>>::iterator begin,
+                 typename vector<WeightedEdge<Weight>>::iterator end);
+    
+    /// Returns true once there are few enough clusters
+    inline bool done() const;
+    
+    /// The total order that the edges are merged in
+    inline static bool edge_less(const WeightedEdge<Weight>& a, const WeightedEdge<Weight>& b);
+    
+    SingleLinkageClustering<Weight> clustering;
+    
+private:
+    
+    /// Merge along the edges in a range in sorted order
+    void process_sorted(typename vector<WeightedEdge<Weight>>::iterator begin,
+                        typename vector<WeightedEdge<Weight>>::iterator end);
+    
+    /// Move the edges within a cluster to the end of a range, and return the new end
+    typename vector<WeightedEdge<Weight>>::iterator filter(typename vector<WeightedEdge<Weight>>::iterator begin,
+                                                           typename vector<WeightedEdge<Weight>>::iterator end);
+    
+    /// Ranges at most this long are sorted rather than partitioned
+    size_t base_size;
+    
+    size_t num_clusters;
+    size_t num_threads;
+    
+    /// The dendrogram's ID for the cluster of each head
+    vector<size_t> cluster_ids;
+};
+
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+namespace detail {
+
+template <typename Iterator, typename Compare>
+void parallel_sort(Iterator begin, Iterator end, Compare compare, size_t num_threads) {
+    
+    size_t size = end - begin;
+    num_threads = max<size_t>(min(num_threads, size / 1024), 1);
+    if (num_threads == 1) {
+        sort(begin, end, compare);
+        return;
+    }
+    
+    // these are the same chunks that parallel_chunks gives each thread
+    vector<size_t> boundaries(num_threads + 1);
+    for (size_t t = 0; t <= num_threads; t++) {
+        boundaries[t] = (size * t) / num_threads;
+    }
+    parallel_chunks(size, num_threads, [&](size_t, size_t chunk_begin, size_t chunk_end) {
+        sort(begin + chunk_begin, begin + chunk_end, compare);
+    });
+    
+    // merge adjacent chunks, halving the number of chunks in each round
+    while (boundaries.size() > 2) {
+        size_t num_merges = (boundaries.size() - 1) / 2;
+        // each thread gets a chunk of one merge
+        parallel_chunks(num_merges, num_merges, [&](size_t m, size_t, size_t) {
+            inplace_merge(begin + boundaries[2 * m], begin + boundaries[2 * m + 1],
+                          begin + boundaries[2 * m + 2], compare);
+        });
+        // an odd chunk out waits for the next round
+        vector<size_t> next_boundaries;
+        for (size_t c = 0; c + 1 < boundaries.size(); c += 2) {
+            next_boundaries.push_back(boundaries[c]);
+        }
+        next_boundaries.push_back(size);
+        boundaries = move(next_boundaries);
+    }
+}
+
+template <typename Weight>
+FilterKruskal<Weight>::FilterKruskal(size_t num_vertices, size_t num_clusters, size_t num_threads)
+    : base_size(max<size_t>(num_threads, 1) << 14), num_clusters(num_clusters), num_threads(num_threads),
+      cluster_ids(num_vertices) {
+    clustering.clusters = UnionFind(num_vertices);
+    clustering.dendrogram.reserve(num_vertices);
+    clustering.spanning_edges.reserve(num_vertices);
+    for (size_t i = 0; i < num_vertices; i++) {
+        cluster_ids[i] = i;
+    }
+}
+
+template <typename Weight>
+inline bool FilterKruskal<Weight>::done() const {
+    return clustering.clusters.num_groups() <= num_clusters;
+}
+
+template <typename Weight>
+inline bool FilterKruskal<Weight>::edge_less(const WeightedEdge<Weight>& a, const WeightedEdge<Weight>& b) {
+    if (a.weight != b.weight) {
+        return a.weight < b.weight;
+    }
+    else if (a.first != b.first) {
+        return a.first < b.first;
+    }
+    else {
+        return a.second < b.second;
+    }
+}
+
+template <typename Weight>
+void FilterKruskal<Weight>::process(typename vector<WeightedEdge<Weight>>::iterator begin,
+                                    typename vector<WeightedEdge<Weight>>::iterator end) {
+    
+    size_t size = end - begin;
+    if (size <= base_size) {
+        process_sorted(begin, end);
+        return;
+    }
+    
+    // take the median of a sample of the edges as the pivot
+    vector<WeightedEdge<Weight>> sample;
+    for (size_t k = 0; k < 64; k++) {
+        sample.push_back(*(begin + (size * k) / 64));
+    }
+    nth_element(sample.begin(), sample.begin() + 32, sample.end(), edge_less);
+    WeightedEdge<Weight> pivot = sample[32];
+    
+    auto middle = partition(begin, end, [&](const WeightedEdge<Weight>& edge) {
+        return !edge_less(pivot, edge);
+    });
+    if (middle == end) {
+        // the pivot was the heaviest edge, so partitioning did not make progress
+        process_sorted(begin, end);
+        return;
+    }
+    
+    process(begin, middle);
+    if (!done()) {
+        process(middle, filter(middle, end));
+    }
+}
+
+template <typename Weight>
+void FilterKruskal<Weight>::process_sorted(typename vector<WeightedEdge<Weight>>::iterator begin,
+                                           typename vector<WeightedEdge<Weight>>::iterator end) {
+    
+    parallel_sort(begin, end, edge_less, num_threads);
+    
+    UnionFind& clusters = clustering.clusters;
+    for (auto iter = begin; iter != end && !done(); ++iter) {
+        const WeightedEdge<Weight>& edge = *iter;
+        size_t head_1 = clusters.find_group(edge.first);
+        size_t head_2 = clusters.find_group(edge.second);
+        if (head_1 == head_2) {
+            continue;
+        }
+        clusters.union_groups(head_1, head_2);
+        size_t head = clusters.find_group(head_1);
+        
+        clustering.dendrogram.push_back(DendrogramMerge<Weight>{cluster_ids[head_1], cluster_ids[head_2],
+                                                                 edge.weight, clusters.group_size(head)});
+        clustering.spanning_edges.push_back(edge);
+        cluster_ids[head] = cluster_ids.size() + clustering.dendrogram.size() - 1;
+    }
+}
+
+template <typename Weight>
+typename vector<WeightedEdge<Weight>>::iterator
+FilterKruskal<Weight>::filter(typename vector<WeightedEdge<Weight>>::iterator begin,
+                              typename vector<WeightedEdge<Weight>>::iterator end) {
+    
+    // mark the edges within a cluster, which only reads the clusters so it can be split
+    // between threads
+    size_t size = end - begin;
+    size_t num_chunks = max<size_t>(min(num_threads, size / 1024), 1);
+    vector<uint8_t> keep(size);
+    const UnionFind& clusters = clustering.clusters;
+    parallel_chunks(size, num_chunks, [&](size_t, size_t chunk_begin, size_t chunk_end) {
+        for (size_t k = chunk_begin; k < chunk_end; k++) {
+            const WeightedEdge<Weight>& edge = *(begin + k);
+            keep[k] = (clusters.find_group_const(edge.first) != clusters.find_group_const(edge.second));
+        }
+    });
+    
+    auto new_end = begin;
+    for (size_t k = 0; k < size; k++) {
+        if (keep[k]) {
+            *new_end = *(begin + k);
+            ++new_end;
+        }
+    }
+    return new_end;
+}
+
+}
+
+template <typename Weight>
+SingleLinkageClustering<Weight> single_linkage(size_t num_vertices, vector<WeightedEdge<Weight>> edges,
+                                               size_t num_clusters, Weight max_weight, size_t num_threads) {
+    
+    // edges above the threshold can never be used, so don't bother sorting them
+    auto new_end = remove_if(edges.begin(), edges.end(), [&](const WeightedEdge<Weight>& edge) {
+        return edge.weight > max_weight;
+    });
+    
+    detail::FilterKruskal<Weight> engine(num_vertices, num_clusters, num_threads);
+    engine.process(edges.begin(), new_end);
+    return move(engine.clustering);
+}
+
+}
+
+#endif /* structures_single_linkage_hpp */
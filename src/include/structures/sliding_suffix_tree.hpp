@@ -0,0 +1,199 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+//  sliding_suffix_tree.hpp
+//
+// Suffix tree over a sliding window of a stream, maintained online with Larsson's
+// extension of Ukkonen's algorithm
+//
+
+
+#ifndef structures_sliding_suffix_tree_hpp
+#define structures_sliding_suffix_tree_hpp
+
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace structures {
+
+using namespace std;
+
+/**
+ * A suffix tree of the most recent characters of a stream. Characters are appended to
+ * the back of the window and expired from the front, both in amortized constant time,
+ * so that memory is bounded by the window size regardless of the length of the stream.
+ * Positions are reported as offsets from the beginning of the stream.
+ *
+ * Since there is no terminator, any char value (including null) can be used.
+ */
+class SlidingSuffixTree {
+    
+public:
+    /// Construct an empty tree whose window holds at most this many characters.
+    SlidingSuffixTree(size_t window_size);
+    ~SlidingSuffixTree() = default;
+    
+    /// Add a character to the end of the window. If the window is already full, the
+    /// oldest character is expired first.
+    void append(char c);
+    
+    /// Remove the oldest character from the window, which must not be empty.
+    void expire_front();
+    
+    /// Returns the number of characters currently in the window
+    size_t size() const;
+    
+    /// Returns the maximum number of characters in the window
+    size_t window_size() const;
+    
+    /// Returns the stream position of the oldest character in the window
+    size_t front_position() const;
+    
+    /// Returns the stream position one past the newest character in the window
+    size_t end_position() const;
+    
+    /// Returns the character at a stream position inside the window
+    char at(size_t i) const;
+    
+    /// Returns the length of the longest prefix of str that exactly matches
+    /// a suffix of the window.
+    size_t longest_overlap(const string& str);
+    
+    /// Same semantics as previous
+    size_t longest_overlap(string::const_iterator begin, string::const_iterator end);
+    
+    /// Retuns a vector of all of the stream positions where a string occurs as a
+    /// substring of the window. Positions are ordered arbitrarily.
+    vector<size_t> substring_locations(const string& str);
+    vector<size_t> substring_locations(string::const_iterator begin, string::const_iterator end);
+    
+private:
+    struct SWNode;
+    
+    /// All nodes in the tree, addressed by index, with the root at index 0
+    vector<SWNode> nodes;
+    
+    /// Indexes of entries in nodes that can be reused
+    vector<size_t> free_nodes;
+    
+    /// Circular buffer of the window's characters, indexed by stream position
+    vector<char> buffer;
+    
+    /// The leaf of each explicit suffix in the window, indexed by stream position
+    vector<size_t> leaf_of;
+    
+    /// Stream position of the oldest character in the window
+    size_t front = 0;
+    /// Stream position past the newest character in the window
+    size_t back = 0;
+    
+    /// The active point, which is the locus of the longest suffix of the window that
+    /// occurs elsewhere in it (and thus has no leaf of its own). The length of this
+    /// suffix is always the depth of the active node plus the active length.
+    size_t active_node = 0;
+    int64_t active_length = 0;
+    /// The number of suffixes that are implicit in the tree
+    int64_t remaining = 0;
+    
+    /// Returns the character at a stream position
+    inline char get_char(size_t i) const;
+    
+    /// Returns a node that has been reset for reuse
+    size_t new_node(size_t parent, int64_t depth, size_t position, bool leaf);
+    
+    /// Returns the node's edge from its parent as its first stream position and its length
+    inline size_t label_begin(size_t node) const;
+    inline int64_t label_length(size_t node) const;
+    
+    /// Returns the child of the active node along the active edge
+    inline size_t active_edge() const;
+    
+    /// Walk the active point down the tree until it is on the edge that contains it
+    void canonize();
+    
+    /// Move the active point from the suffix that was just made explicit to the next
+    /// shorter suffix
+    void advance_active_point();
+    
+    /// Send a fresh occurrence position of the node's string up the tree, spending and
+    /// collecting credits so that every internal node's edge stays inside the window
+    void update_position(size_t node, size_t position);
+    
+    /// Returns the locus of the string as the node below it and whether it was found
+    bool find_locus(string::const_iterator begin, string::const_iterator end, size_t& locus);
+    
+    /// Returns the KMP failure function of a string
+    vector<int64_t> failure_function(string::const_iterator begin, string::const_iterator end) const;
+};
+
+
+/**
+ * A node of a sliding suffix tree. Edge labels are not stored directly, but rather inferred
+ * from a stream position where the node's string occurs and the depths of the node and
+ * its parent.
+ */
+struct SlidingSuffixTree::SWNode {
+    
+    /// Edges down the tree
+    unordered_map<char, size_t> children;
+    
+    /// The node above this one
+    size_t parent = 0;
+    
+    /// The length of the string spelled from the root to this node (not used for leaves,
+    /// which always extend to the end of the window)
+    int64_t depth = 0;
+    
+    /// For leaves, the stream position of the suffix. For internal nodes, a stream position
+    /// where the node's string occurs inside the window.
+    size_t position = 0;
+    
+    /// The suffix link of an internal node
+    size_t suffix_link = 0;
+    
+    /// Whether this node is holding a position it has not passed on to its parent yet
+    bool credit = false;
+    
+    /// Whether this node is a leaf
+    bool leaf = false;
+};
+
+inline char SlidingSuffixTree::get_char(size_t i) const {
+    return buffer[i % buffer.size()];
+}
+
+inline size_t SlidingSuffixTree::label_begin(size_t node) const {
+    return nodes[node].position + nodes[nodes[node].parent].depth;
+}
+
+inline int64_t SlidingSuffixTree::label_length(size_t node) const {
+    const SWNode& n = nodes[node];
+    return n.leaf ? back - n.position - nodes[n.parent].depth : n.depth - nodes[n.parent].depth;
+}
+
+inline size_t SlidingSuffixTree::active_edge() const {
+    return nodes[active_node].children.at(get_char(back - remaining + nodes[active_node].depth));
+}
+
+}
+
+
+
+#endif /* structures_sliding_suffix_tree_hpp */
@@ -0,0 +1,83 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+//  snapshot_union_find.hpp
+//
+// Contains a wrapper that publishes snapshots of a union-find to reader threads
+//
+
+#ifndef structures_snapshot_union_find_hpp
+#define structures_snapshot_union_find_hpp
+
+#include <memory>
+
+#include "structures/union_find.hpp"
+
+namespace structures {
+
+using namespace std;
+
+/**
+ * A UnionFind with a single writer and any number of reader threads, in the style of
+ * read-copy-update. The writer applies unions to its own copy and publishes a snapshot
+ * whenever it wants the readers to see them. Readers take the latest snapshot and query
+ * it with the const methods of UnionFind, which never change it, so neither side waits
+ * for the other. The writer pays for this in publish, which flattens its trees and copies
+ * the arrays that the const queries use, so each publish takes O(n) time and memory for n
+ * indices no matter how few unions there have been since the last one.
+ */
+class SnapshotUnionFind {
+public:
+    /// Construct SnapshotUnionFind for this many indices, and publish them in separate groups
+    SnapshotUnionFind(size_t size);
+    
+    /// Destructor
+    ~SnapshotUnionFind();
+    
+    /// Returns the number of indices in the writer's UnionFind
+    size_t size() const;
+    
+    /// Adds a new index in a group by itself to the writer's UnionFind and returns it
+    size_t add_element();
+    
+    /// Returns the group ID of index i in the writer's UnionFind
+    size_t find_group(size_t i);
+    
+    /// Merges the group containing index i with the group containing index j in the writer's
+    /// UnionFind. Readers do not see the merge until the next publish.
+    void union_groups(size_t i, size_t j);
+    
+    /// Makes the writer's current groups visible to readers in linear time
+    void publish();
+    
+    /// Returns the most recently published groups. Can be called from any thread, and
+    /// the snapshot remains valid for as long as it is held.
+    shared_ptr<const UnionFind> snapshot() const;
+    
+private:
+    
+    /// The groups that the writer is changing
+    UnionFind writer;
+    
+    /// The groups that readers can see, which are only accessed atomically
+    shared_ptr<const UnionFind> published;
+};
+
+}
+
+#endif /* structures_snapshot_union_find_hpp */
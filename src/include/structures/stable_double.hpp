@@ -132,7 +132,7 @@ ostream& operator<<(ostream& out, const StableDouble& val);
 
 
 inline double StableDouble::add_log(const double log_x, const double log_y) const {
-    return log_x > log_y ? log_x + log1p(exp(log_y - log_x)) : log_y + log(exp(log_x - log_y));
+    return log_x > log_y ? log_x + log1p(exp(log_y - log_x)) : log_y + log1p(exp(log_x - log_y));
 }
 
 inline double StableDouble::subtract_log(const double log_x, const double log_y) const {
@@ -26,6 +26,8 @@
 #define structures_suffix_tree_hpp
 
 #include <unordered_map>
+#include <memory>
+#include <limits>
 #include <list>
 #include <string>
 #include <vector>
@@ -36,6 +38,43 @@ namespace structures {
 
 using namespace std;
 
+/**
+ * Counters for the work done by a SuffixTree, which can help explain slow constructions and
+ * queries. They are only collected if the library is compiled with STRUCTURES_SUFFIX_TREE_STATS
+ * defined (e.g. with `make STATS=1`), and otherwise they remain zero.
+ */
+struct SuffixTreeStats {
+    /// Edges split to make internal nodes during construction
+    size_t node_splits = 0;
+    /// Suffix links followed during construction
+    size_t suffix_link_hops = 0;
+    /// Lookups of a child by its first character, during construction and queries
+    size_t child_lookups = 0;
+    /// Nodes visited while collecting locations in substring_locations
+    size_t dfs_nodes_visited = 0;
+};
+
+/**
+ * The approximate memory used by the components of a SuffixTree in bytes, not including
+ * the string itself (which the tree does not own) or allocator overhead.
+ */
+struct SuffixTreeMemoryUsage {
+    /// The node objects, which include 16 bytes per node for the leaf ranges used by sorted
+    /// queries whether or not the position index has been built
+    size_t nodes = 0;
+    /// The hash tables of edges, including the root's
+    size_t edges = 0;
+    /// The table of suffix links, which is only held during construction
+    size_t construction_suffix_links = 0;
+    /// The index of leaf positions for sorted queries, once it has been built
+    size_t position_index = 0;
+    /// The index for longest common extension queries, once it has been built
+    size_t lce_index = 0;
+    
+    /// Returns the memory held after construction
+    size_t total() const;
+};
+
 /**
  * An implementation of a suffix tree with linear time and space complexity for construction.
  */
@@ -43,44 +82,128 @@ class SuffixTree {
     
 public:
     /// Linear time constructor.
-    ///
-    /// Note: string cannot have null characters, but this is not checked.
     SuffixTree(string::const_iterator begin, string::const_iterator end);
+    
+    /// Linear time constructor over a span of memory, such as a mapped file. The tree refers
+    /// to the span rather than copying it, so it must outlive the tree. Any byte values can
+    /// be used, including null, since the end of the text is marked out-of-band.
+    SuffixTree(const char* begin, const char* end);
+    SuffixTree(const uint8_t* begin, const uint8_t* end);
     ~SuffixTree() = default;
     
     /// Returns the length of the longest prefix of str that exactly matches
     /// a suffix of the string used to construct the suffix tree.
-    ///
-    /// Note: string cannot have null characters, but this is not checked.
     size_t longest_overlap(const string& str);
     
     /// Same semantics as previous
     size_t longest_overlap(string::const_iterator begin, string::const_iterator end);
+    size_t longest_overlap(const char* begin, const char* end);
     
     /// Retuns a vector of all of the indices where a string occurs as a substring
     /// of the string used to construct the suffix tree. Indices are ordered arbitrarily.
-    ///
-    /// Note: string cannot have null characters, but this is not checked.
     vector<size_t> substring_locations(const string& str);
     vector<size_t> substring_locations(string::const_iterator begin, string::const_iterator end);
+    vector<size_t> substring_locations(const char* begin, const char* end);
+    
+    /// Returns a sorted vector of the indices in [window_begin, window_end) where a string occurs
+    /// as a substring of the string used to construct the suffix tree. The first call builds
+    /// an index of the leaves in O(n log n) time and O(n) words of memory, after which each
+    /// query takes O(m + (k + 1) log n) time to report k indices, without sorting.
+    vector<size_t> sorted_substring_locations(const string& str, size_t window_begin = 0,
+                                              size_t window_end = numeric_limits<size_t>::max());
+    vector<size_t> sorted_substring_locations(string::const_iterator begin, string::const_iterator end,
+                                              size_t window_begin = 0,
+                                              size_t window_end = numeric_limits<size_t>::max());
+    vector<size_t> sorted_substring_locations(const char* begin, const char* end,
+                                              size_t window_begin = 0,
+                                              size_t window_end = numeric_limits<size_t>::max());
+    
+    /// Returns the length of the longest common prefix of the suffixes that begin at two indices
+    /// of the string used to construct the suffix tree. The first call builds an index in
+    /// O(n) time and about 3.5 words of memory per character, after which each query takes
+    /// constant time.
+    size_t longest_common_extension(size_t i, size_t j);
+    
+    /// Returns the counters of work done since construction or the last reset
+    const SuffixTreeStats& stats() const;
+    
+    /// Sets the counters back to zero, for instance to measure queries separately from construction
+    void reset_stats();
+    
+    /// Returns the memory used by each component of the tree in linear time
+    SuffixTreeMemoryUsage memory_usage() const;
     
     /// Beginning of string used to make tree
-    const string::const_iterator begin;
+    const char* const begin;
     
     /// End of string used to make tree
-    const string::const_iterator end;
+    const char* const end;
     
 private:
     struct STNode;
+    struct LeafPositionIndex;
     
     /// All nodes in the tree (in a list to avoid difficulties with pointers and reallocations)
     list<STNode> nodes;
     
     /// The edges from the root node
-    unordered_map<char, STNode*> root;
+    unordered_map<int, STNode*> root;
+    
+    /// Work counters, which are only incremented if STRUCTURES_SUFFIX_TREE_STATS is defined
+    SuffixTreeStats counters;
+    
+    /// The size of the suffix link table at the end of construction
+    size_t construction_suffix_link_bytes = 0;
+    
+    /// The positions of the leaves in depth-first order, which is built on demand
+    unique_ptr<LeafPositionIndex> position_index;
+    
+    /// The depth-first rank of each suffix's leaf, which is built on demand
+    vector<size_t> suffix_ranks;
+    
+    /// The LCP of each leaf with the previous leaf in depth-first order, which is built on demand
+    vector<size_t> adjacent_lcps;
+    
+    /// For each leaf, the bits of the leaves in its block of 64 whose LCP is smaller than every
+    /// later LCP up to this leaf, which answers minimum queries inside of a block
+    vector<uint64_t> lcp_block_masks;
+    
+    /// Sparse table of the minimum LCPs of runs of 2^k blocks
+    vector<vector<size_t>> lcp_block_table;
+    
+    /// The symbol that marks the end of the string, which is distinct from every char
+    static const int terminator = 256;
+    
+    /// Returns the symbol of a char, which is its unsigned value
+    static inline int symbol(char c);
+    
+    /// Returns the symbol of a char of the string or the terminator at past-the-last index
+    inline int get_char(size_t i);
+    
+    /// Returns the child along the edge that starts with a symbol, or null if there is none
+    inline STNode* find_child(unordered_map<int, STNode*>& branch_point, int c);
     
-    /// Returns a char of the string or null char at past-the-last index
-    inline char get_char(size_t i);
+    /// Returns the node whose edge contains the end of a match to the entire string, or
+    /// null if there is none, and the number of characters matched along that edge
+    STNode* find_locus(const char* begin, const char* end, size_t& node_idx);
+    
+    /// Number the leaves in depth-first order, and return their suffixes' positions and
+    /// the length of each leaf's LCP with the previous leaf
+    void order_leaves(vector<size_t>& positions, vector<size_t>& adjacent_lcps);
+    
+    /// Index the positions of the leaves in depth-first order
+    void build_position_index();
+    
+    /// Index the ranks and adjacent LCPs of the leaves in depth-first order
+    void build_lce_index();
+    
+    /// Returns the minimum adjacent LCP of the leaves in [rank_begin, rank_end), which must
+    /// be nonempty
+    size_t min_adjacent_lcp(size_t rank_begin, size_t rank_end) const;
+    
+    /// Returns the minimum adjacent LCP of the leaves in [rank_begin, rank_last], which must
+    /// be in the same block
+    inline size_t min_adjacent_lcp_in_block(size_t rank_begin, size_t rank_last) const;
 };
 
 
@@ -93,13 +216,18 @@ struct SuffixTree::STNode {
     ~STNode() = default;
     
     /// Edges down the tree
-    unordered_map<char, STNode*> children;
+    unordered_map<int, STNode*> children;
     
     /// First index of string on this node
     int64_t first;
     /// Last index of string on this node, inclusive (-1 indicates end sentinel during consruction)
     int64_t last;
     
+    /// The range of the leaves below this node in depth-first order, once the position index
+    /// has been built (these add 16 bytes to every node even if it never is)
+    size_t leaf_begin = 0;
+    size_t leaf_end = 0;
+    
     /// The length of the the node during a phase of construction
     inline int64_t length(int64_t phase) {
         return last >= 0 ? last - first + 1 : phase - first + 1;
@@ -111,8 +239,59 @@ struct SuffixTree::STNode {
     }
 };
 
-inline char SuffixTree::get_char(size_t i) {
-    return i == end - begin ? '\0' : *(begin + i);
+/**
+ * A wavelet matrix over the positions of the leaves in depth-first order, which reports the
+ * positions of a range of leaves that fall inside a window in sorted order
+ */
+struct SuffixTree::LeafPositionIndex {
+    /// Construct over positions that are all less than or equal to a maximum
+    LeafPositionIndex(const vector<size_t>& positions, size_t max_position);
+    ~LeafPositionIndex() = default;
+    
+    /// Append the positions in [window_begin, window_end) of the leaves in [rank_begin, rank_end)
+    /// to a vector in sorted order
+    void report(size_t rank_begin, size_t rank_end, size_t window_begin, size_t window_end,
+                vector<size_t>& out) const;
+    
+private:
+    
+    /// Recursive step of report, in the range of a level whose values share a prefix
+    void report(size_t level, size_t prefix, size_t rank_begin, size_t rank_end,
+                size_t window_begin, size_t window_end, vector<size_t>& out) const;
+    
+    /// Returns the number of set bits in a level before an index
+    inline size_t rank1(size_t level, size_t i) const;
+    
+    friend class SuffixTree;
+    
+    /// The number of bits in the positions
+    size_t num_levels;
+    
+    /// The bits of each level, starting from the most significant, packed into words
+    vector<vector<uint64_t>> bits;
+    
+    /// The number of set bits in each level before the beginning of each word
+    vector<vector<size_t>> word_ranks;
+    
+    /// The number of unset bits in each level
+    vector<size_t> num_zeros;
+};
+
+inline size_t SuffixTree::LeafPositionIndex::rank1(size_t level, size_t i) const {
+    size_t word = i / 64;
+    size_t rank = word_ranks[level][word];
+    if (i % 64) {
+        rank += __builtin_popcountll(bits[level][word] << (64 - i % 64));
+    }
+    return rank;
+}
+
+inline int SuffixTree::symbol(char c) {
+    return (unsigned char) c;
+}
+
+inline int SuffixTree::get_char(size_t i) {
+    return i == end - begin ? terminator : symbol(*(begin + i));
 }
 
 
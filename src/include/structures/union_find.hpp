@@ -25,30 +25,134 @@
 #define structures_union_find_hpp
 
 #include <vector>
-#include <unordered_set>
+#include <string>
 #include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <limits>
 #include <algorithm>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "structures/mapped_array.hpp"
 
 namespace structures {
 
 using namespace std;
 
+/*
+ * Helpers for UnionFind that do not depend on its template parameters, which are
+ * implemented in union_find.cpp so that this header does not need threads or POSIX files
+ */
+namespace detail {
+
+/// Split a range into contiguous chunks and process each in its own thread, calling the
+/// function with the thread number and the beginning and end of its chunk
+void parallel_chunks(size_t size, size_t num_threads,
+                     const function<void(size_t, size_t, size_t)>& process_chunk);
+
+/// Write blocks of bytes one after another to a new file, which then replaces any file at
+/// the path. Returns false if the file could not be written.
+bool write_blocks(const string& path, const vector<pair<const void*, size_t>>& blocks);
+
+/// Map a file into memory copy-on-write and record its size. Returns null if the file could
+/// not be mapped. The mapping is released when the last copy of the pointer is destroyed.
+shared_ptr<void> map_file_private(const string& path, size_t& file_size);
+
+}
+
+/**
+ * All of the groups of a UnionFind in compressed sparse row format. The members of
+ * group k are members[offsets[k]], ..., members[offsets[k + 1] - 1].
+ */
+struct UnionFindGroups {
+    /// Returns the number of groups
+    inline size_t num_groups() const;
+    
+    /// The beginning of each group in members, followed by the total number of members
+    vector<size_t> offsets;
+    /// The members of each group, one group after another
+    vector<size_t> members;
+};
+
+/**
+ * Counters for the work done by a UnionFind, which can help choose a find policy and spot
+ * inputs that make long paths. They are only collected by a BasicUnionFind whose CountWork
+ * parameter is true, and otherwise they remain zero.
+ */
+struct UnionFindStats {
+    /// Calls to find, including the ones made by other methods
+    size_t finds = 0;
+    /// The number of finds that started at each distance from the head, with distances of
+    /// 63 or more in the last entry
+    size_t path_lengths[64] = {};
+    /// Indices that were given a new parent while compressing paths
+    size_t reparented = 0;
+    /// Calls to union_groups
+    size_t unions = 0;
+    /// Calls to union_groups that merged two different groups
+    size_t merges = 0;
+    
+    /// Records a find that started at this distance from the head
+    inline void record_find(size_t path_length);
+};
+
+/**
+ * Find policy that points every index on the path directly at the head, in two passes
+ */
+struct FullCompression {
+    template <bool CountWork, typename Index>
+    inline static Index find(MappedArray<Index>& parents, Index i, UnionFindStats& stats);
+};
+
+/**
+ * Find policy that points every other index on the path at its grandparent, in one pass
+ */
+struct PathHalving {
+    template <bool CountWork, typename Index>
+    inline static Index find(MappedArray<Index>& parents, Index i, UnionFindStats& stats);
+};
+
 /**
+ * Find policy that points every index on the path at its grandparent, in one pass
+ */
+struct PathSplitting {
+    template <bool CountWork, typename Index>
+    inline static Index find(MappedArray<Index>& parents, Index i, UnionFindStats& stats);
+};
+
+/*
  * A custom Union-Find data structure that supports merging a set of indices in
  * disjoint sets in amortized nearly linear time. This implementation also supports
  * querying the size of the group containing an index in constant time and querying
  * the members of the group containing an index in linear time in the size of the group.
+ *
+ * The Index type is the unsigned integer that is stored for each index, so uint32_t halves
+ * the memory of uint64_t when there are fewer than 2^32 - 1 indices. The FindPolicy is
+ * FullCompression, PathHalving, or PathSplitting, which all have the same amortized bound
+ * but differ in constant factors depending on the workload. If CountWork is true, the
+ * UnionFind also counts the work done by its finds and unions, at a small cost to each.
  */
-class UnionFind {
+template <typename Index, typename FindPolicy = FullCompression, bool CountWork = false>
+class BasicUnionFind {
 public:
-    /// Construct UnionFind for this many indices
-    UnionFind(size_t size);
+    /// Construct BasicUnionFind for this many indices
+    BasicUnionFind(size_t size = 0);
     
     /// Destructor
-    ~UnionFind();
+    ~BasicUnionFind() = default;
     
     /// Returns the number of indices in the UnionFind
-    size_t size();
+    size_t size() const;
+    
+    /// Adds a new index in a group by itself and returns it, in amortized constant time.
+    /// Existing indices and group IDs are not affected.
+    size_t add_element();
+    
+    /// Allocates space for this many indices in total, so that adding elements up to that
+    /// number will not reallocate
+    void reserve(size_t size);
     
     /// Returns the group ID that index i belongs to (can change after calling union)
     size_t find_group(size_t i);
@@ -59,18 +163,743 @@ public:
     /// Returns the size of the group containing index i
     size_t group_size(size_t i);
     
+    /// Returns the same group ID as find_group without compressing the path, so that it
+    /// can be called on a UnionFind that is shared between threads and not being changed
+    size_t find_group_const(size_t i) const;
+    
+    /// Returns the same size as group_size without compressing the path
+    size_t group_size_const(size_t i) const;
+    
     /// Returns a vector of the indices in the same group as index i
-    vector<size_t> group(size_t i);
+    vector<size_t> group(size_t i) const;
+    
+    /// Calls a function on each index in the same group as index i, beginning with i, in
+    /// linear time in the size of the group and without allocating
+    template <typename Function>
+    void for_each_member(size_t i, Function f) const;
+    
+    /// Returns the number of groups in constant time
+    size_t num_groups() const;
+    
+    /// Returns the number of groups with sizes in each power of 2 range, so that entry k is
+    /// the number of groups with size in [2^k, 2^(k+1)), up to the largest nonempty range
+    vector<size_t> group_size_histogram() const;
     
     /// Returns all of the groups, each in a separate vector
     vector<vector<size_t>> all_groups();
     
+    /// Points every index directly at its group ID, so that later finds take one step. If
+    /// relabeling, also renumbers the indices so that each group's members are contiguous,
+    /// in order of the groups' IDs and then of the members, and returns the new index of each
+    /// old index (else returns an empty vector). Change tracking epochs remain valid.
+    vector<size_t> compact(bool relabel = false);
+    
+    /// Returns a copy of the groups in linear time for threads that only use the const
+    /// queries. Unlike the copy constructor, it leaves out the change log and the counters,
+    /// so the copy does not track changes until its first checkpoint.
+    BasicUnionFind copy_groups() const;
+    
+    /// Returns all of the groups in two flat arrays, in the same order as all_groups. With
+    /// more than one thread, the members are counting sorted by their group IDs in parallel
+    /// without compressing any paths.
+    UnionFindGroups all_groups_csr(size_t num_threads = 1);
+    
+    /// Returns a parent forest of the groups, in which each index points to its group ID.
+    /// The forest can be sent elsewhere and merged with merge_from_forest.
+    vector<size_t> parent_forest();
+    
+    /// Merges every group of another UnionFind into this one, with the other's index k
+    /// corresponding to index_map[k] here, or to k if the map is empty. Takes one union per
+    /// index that is not the head of its group in the other UnionFind.
+    void merge_from(const BasicUnionFind& other, const vector<size_t>& index_map = vector<size_t>());
+    
+    /// Merges the groups of a parent forest, in which each index points to its parent or to
+    /// itself, with the same index mapping as merge_from
+    void merge_from_forest(const vector<size_t>& forest,
+                           const vector<size_t>& index_map = vector<size_t>());
+    
+    /// Writes the groups to a binary file. The file is written under a temporary name and
+    /// then renamed, so an existing file at the path is replaced rather than overwritten,
+    /// which makes it safe to save to the file that was loaded. Returns false if the file
+    /// could not be written, in which case any existing file is left alone.
+    bool save(const string& path);
+    
+    /// Replaces the groups with the ones saved in a binary file, which is mapped into memory
+    /// copy-on-write rather than read, so that the file is never modified. The parents, sizes
+    /// and member lists are read once to check that they stay in bounds, but the file is
+    /// otherwise trusted, so for instance a cycle of parents is not detected. Returns false
+    /// if the file could not be mapped or is not a valid UnionFind file with the same Index
+    /// type, in which case the groups are unchanged. Changes are not tracked again until the
+    /// next checkpoint. The file must not be truncated or written in place while a UnionFind
+    /// is using it.
+    bool load(const string& path);
+    
+    /// Returns an epoch that marks the current groups, so that the groups that change
+    /// afterwards can be listed. Changes are only recorded after the first checkpoint.
+    size_t checkpoint();
+    
+    /// Returns the current group IDs of the groups that have been merged or added since an
+    /// epoch, in ascending order, in time proportional to the number of changes
+    vector<size_t> changed_groups_since(size_t epoch);
+    
+    /// Frees the record of changes before an epoch, which can no longer be queried
+    void discard_changes_before(size_t epoch);
+    
+    /// Returns the counters of work done since construction or the last reset
+    const UnionFindStats& stats() const;
+    
+    /// Sets the counters back to zero, for instance to measure one phase of a workload
+    void reset_stats();
+    
+    /// Returns the number of heads with each rank, up to the largest rank, in linear time.
+    /// Unlike the counters, this is always available.
+    vector<size_t> rank_distribution() const;
+    
 private:
     
-    struct UFNode;
-    vector<UFNode> uf_nodes;
+    /// The beginning of a saved UnionFind, which is followed by its parents, sizes, next
+    /// members, and ranks
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t index_width;
+        uint64_t size;
+        uint64_t num_groups;
+        uint64_t size_histogram[64];
+    };
+    
+    /// The version of the saved format
+    static const uint32_t file_version = 2;
+    
+    /// Returns the entry of the size histogram that a group of this size belongs to
+    inline static size_t size_bucket(size_t size);
+    
+    /// Merge the groups of a parent forest through an index map
+    template <typename ForestIndex>
+    void merge_parents(const ForestIndex* forest, size_t size, const vector<size_t>& index_map);
+    
+    /// The parent of each index in its group's tree, which is itself for the head
+    MappedArray<Index> parents;
+    
+    /// An upper bound on the height of each head's tree
+    MappedArray<uint8_t> ranks;
+    
+    /// The size of each head's group (not maintained for other indices)
+    MappedArray<Index> sizes;
+    
+    /// The next index in a circular list of the members of each index's group
+    MappedArray<Index> next_members;
+    
+    /// The number of groups
+    size_t group_count;
+    
+    /// The number of groups with size in [2^k, 2^(k+1)) for each k
+    vector<size_t> size_histogram;
+    
+    /// Whether merged and added groups are being recorded
+    bool tracking_changes;
+    
+    /// An index in each group that was merged or added, in order
+    vector<size_t> change_log;
+    
+    /// The epoch of the first change in the log
+    size_t change_log_begin;
+    
+    /// Work counters, which are only incremented if CountWork is true
+    UnionFindStats counters;
 };
 
+/// The default UnionFind, with the same index width as the platform
+typedef BasicUnionFind<size_t, FullCompression> UnionFind;
+
+
+
+
+
+
+
+
+
+
+
+
+
+inline size_t UnionFindGroups::num_groups() const {
+    return offsets.size() - 1;
+}
+
+inline void UnionFindStats::record_find(size_t path_length) {
+    finds++;
+    path_lengths[min<size_t>(path_length, 63)]++;
+}
+
+template <bool CountWork, typename Index>
+inline Index FullCompression::find(MappedArray<Index>& parents, Index i, UnionFindStats& stats) {
+    // traverse tree upwards
+    Index head = i;
+    size_t path_length = 0;
+    while (parents[head] != head) {
+        head = parents[head];
+        if (CountWork) {
+            path_length++;
+        }
+    }
+    if (CountWork) {
+        stats.record_find(path_length);
+    }
+    // compress path
+    while (parents[i] != head) {
+        Index next = parents[i];
+        parents[i] = head;
+        i = next;
+        if (CountWork) {
+            stats.reparented++;
+        }
+    }
+    return head;
+}
+
+template <bool CountWork, typename Index>
+inline Index PathHalving::find(MappedArray<Index>& parents, Index i, UnionFindStats& stats) {
+    size_t path_length = 0;
+    while (parents[i] != i) {
+        if (CountWork) {
+            // we pass over the parent, unless it is the head
+            bool skips_parent = (parents[parents[i]] != parents[i]);
+            path_length += skips_parent ? 2 : 1;
+            stats.reparented += skips_parent ? 1 : 0;
+        }
+        // skip to the grandparent, and move on from there
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+    if (CountWork) {
+        stats.record_find(path_length);
+    }
+    return i;
+}
+
+template <bool CountWork, typename Index>
+inline Index PathSplitting::find(MappedArray<Index>& parents, Index i, UnionFindStats& stats) {
+    size_t path_length = 0;
+    while (parents[i] != i) {
+        // point at the grandparent, but move on to the parent
+        Index next = parents[i];
+        if (CountWork) {
+            path_length++;
+            stats.reparented += (parents[next] != next) ? 1 : 0;
+        }
+        parents[i] = parents[next];
+        i = next;
+    }
+    if (CountWork) {
+        stats.record_find(path_length);
+    }
+    return i;
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+const uint32_t BasicUnionFind<Index, FindPolicy, CountWork>::file_version;
+
+template <typename Index, typename FindPolicy, bool CountWork>
+inline size_t BasicUnionFind<Index, FindPolicy, CountWork>::size_bucket(size_t size) {
+    return 63 - __builtin_clzll(size);
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+BasicUnionFind<Index, FindPolicy, CountWork>::BasicUnionFind(size_t size) : parents(size), ranks(size, 0), sizes(size, 1),
+                                                                 next_members(size), group_count(size),
+                                                                 size_histogram(64, 0), tracking_changes(false),
+                                                                 change_log_begin(0) {
+    assert(size < size_t(numeric_limits<Index>::max()));
+    for (size_t i = 0; i < size; i++) {
+        parents[i] = i;
+        next_members[i] = i;
+    }
+    size_histogram[0] = size;
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+size_t BasicUnionFind<Index, FindPolicy, CountWork>::size() const {
+    return parents.size();
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+size_t BasicUnionFind<Index, FindPolicy, CountWork>::add_element() {
+    size_t i = parents.size();
+    assert(i + 1 < size_t(numeric_limits<Index>::max()));
+    parents.push_back(i);
+    ranks.push_back(0);
+    sizes.push_back(1);
+    next_members.push_back(i);
+    group_count++;
+    size_histogram[0]++;
+    if (tracking_changes) {
+        change_log.push_back(i);
+    }
+    return i;
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+void BasicUnionFind<Index, FindPolicy, CountWork>::reserve(size_t size) {
+    parents.reserve(size);
+    ranks.reserve(size);
+    sizes.reserve(size);
+    next_members.reserve(size);
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+size_t BasicUnionFind<Index, FindPolicy, CountWork>::find_group(size_t i) {
+    return FindPolicy::template find<CountWork>(parents, Index(i), counters);
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+void BasicUnionFind<Index, FindPolicy, CountWork>::union_groups(size_t i, size_t j) {
+    size_t head_i = find_group(i);
+    size_t head_j = find_group(j);
+    if (CountWork) {
+        counters.unions++;
+    }
+    if (head_i == head_j) {
+        // the indices are already in the same group
+        return;
+    }
+    else {
+        if (CountWork) {
+            counters.merges++;
+        }
+        // move the two groups' entries in the histogram to the merged group's
+        group_count--;
+        size_histogram[size_bucket(sizes[head_i])]--;
+        size_histogram[size_bucket(sizes[head_j])]--;
+        size_histogram[size_bucket(sizes[head_i] + sizes[head_j])]++;
+        
+        // use rank as a pivot to determine which group to make the head
+        if (ranks[head_i] > ranks[head_j]) {
+            parents[head_j] = head_i;
+            sizes[head_i] += sizes[head_j];
+        }
+        else {
+            parents[head_i] = head_j;
+            sizes[head_j] += sizes[head_i];
+            
+            if (ranks[head_j] == ranks[head_i]) {
+                ranks[head_j]++;
+            }
+        }
+        // exchanging successors splices the two circular member lists into one
+        swap(next_members[head_i], next_members[head_j]);
+        
+        if (tracking_changes) {
+            // either head identifies the merged group from now on
+            change_log.push_back(head_i);
+        }
+    }
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+size_t BasicUnionFind<Index, FindPolicy, CountWork>::group_size(size_t i) {
+    return sizes[find_group(i)];
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+size_t BasicUnionFind<Index, FindPolicy, CountWork>::find_group_const(size_t i) const {
+    while (parents[i] != i) {
+        i = parents[i];
+    }
+    return i;
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+size_t BasicUnionFind<Index, FindPolicy, CountWork>::group_size_const(size_t i) const {
+    return sizes[find_group_const(i)];
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+size_t BasicUnionFind<Index, FindPolicy, CountWork>::num_groups() const {
+    return group_count;
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+vector<size_t> BasicUnionFind<Index, FindPolicy, CountWork>::group_size_histogram() const {
+    size_t num_buckets = size_histogram.size();
+    while (num_buckets > 0 && size_histogram[num_buckets - 1] == 0) {
+        num_buckets--;
+    }
+    return vector<size_t>(size_histogram.begin(), size_histogram.begin() + num_buckets);
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+vector<size_t> BasicUnionFind<Index, FindPolicy, CountWork>::group(size_t i) const {
+    vector<size_t> to_return;
+    to_return.reserve(group_size_const(i));
+    for_each_member(i, [&](size_t member) {
+        to_return.push_back(member);
+    });
+    return to_return;
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+template <typename Function>
+void BasicUnionFind<Index, FindPolicy, CountWork>::for_each_member(size_t i, Function f) const {
+    // walk around the circular list of members
+    size_t curr = i;
+    do {
+        f(curr);
+        curr = next_members[curr];
+    } while (curr != i);
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+vector<vector<size_t>> BasicUnionFind<Index, FindPolicy, CountWork>::all_groups() {
+    vector<vector<size_t>> to_return(parents.size());
+    for (size_t i = 0; i < parents.size(); i++) {
+        to_return[find_group(i)].push_back(i);
+    }
+    auto new_end = std::remove_if(to_return.begin(), to_return.end(),
+                                  [](const vector<size_t>& grp) { return grp.empty(); });
+    to_return.resize(new_end - to_return.begin());
+    return to_return;
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+vector<size_t> BasicUnionFind<Index, FindPolicy, CountWork>::compact(bool relabel) {
+    
+    // point each index at its head explicitly, since some policies only shorten the path
+    for (size_t i = 0; i < parents.size(); i++) {
+        parents[i] = find_group(i);
+    }
+    if (!relabel) {
+        return vector<size_t>();
+    }
+    
+    // give each group a range of new indices, in order of the heads, and the first new index
+    // in the range becomes the group's head
+    vector<size_t> new_heads(parents.size());
+    vector<size_t> next_index(parents.size());
+    size_t group_begin = 0;
+    for (size_t i = 0; i < parents.size(); i++) {
+        if (parents[i] == i) {
+            new_heads[i] = group_begin;
+            next_index[i] = group_begin;
+            group_begin += sizes[i];
+        }
+    }
+    vector<size_t> new_indices(parents.size());
+    for (size_t i = 0; i < parents.size(); i++) {
+        new_indices[i] = next_index[parents[i]]++;
+    }
+    
+    MappedArray<Index> new_parents(parents.size());
+    MappedArray<uint8_t> new_ranks(parents.size(), 0);
+    MappedArray<Index> new_sizes(parents.size(), 1);
+    MappedArray<Index> new_next_members(parents.size());
+    for (size_t i = 0; i < parents.size(); i++) {
+        size_t head = parents[i];
+        size_t new_head = new_heads[head];
+        new_parents[new_indices[i]] = new_head;
+        if (i == head) {
+            new_ranks[new_head] = ranks[head];
+            new_sizes[new_head] = sizes[head];
+        }
+        // the members of each group are now linked in order, wrapping around to the head
+        size_t next = new_indices[i] + 1;
+        new_next_members[new_indices[i]] = (next == new_head + sizes[head]) ? new_head : next;
+    }
+    parents = move(new_parents);
+    ranks = move(new_ranks);
+    sizes = move(new_sizes);
+    next_members = move(new_next_members);
+    
+    // the logged indices still identify the same groups under their new numbers
+    for (size_t& logged : change_log) {
+        logged = new_indices[logged];
+    }
+    
+    return new_indices;
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+BasicUnionFind<Index, FindPolicy, CountWork> BasicUnionFind<Index, FindPolicy, CountWork>::copy_groups() const {
+    BasicUnionFind copy;
+    copy.parents = parents;
+    copy.ranks = ranks;
+    copy.sizes = sizes;
+    copy.next_members = next_members;
+    copy.group_count = group_count;
+    copy.size_histogram = size_histogram;
+    return copy;
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+UnionFindGroups BasicUnionFind<Index, FindPolicy, CountWork>::all_groups_csr(size_t num_threads) {
+    
+    UnionFindGroups groups;
+    groups.members.resize(parents.size());
+    
+    if (num_threads <= 1) {
+        // count the members of each group, which are all attributed to the head
+        vector<size_t> heads(parents.size());
+        vector<size_t> next_offset(parents.size(), 0);
+        for (size_t i = 0; i < parents.size(); i++) {
+            heads[i] = find_group(i);
+            next_offset[heads[i]]++;
+        }
+        
+        // lay out the groups in order of their heads
+        groups.offsets.push_back(0);
+        for (size_t i = 0; i < parents.size(); i++) {
+            if (next_offset[i] != 0) {
+                size_t group_begin = groups.offsets.back();
+                groups.offsets.push_back(group_begin + next_offset[i]);
+                next_offset[i] = group_begin;
+            }
+        }
+        
+        // place the members, which come out in ascending order within each group
+        for (size_t i = 0; i < parents.size(); i++) {
+            groups.members[next_offset[heads[i]]++] = i;
+        }
+        
+        return groups;
+    }
+    
+    // the heads already know their group sizes, so we can find the offsets without any finds
+    vector<size_t> chunk_num_groups(num_threads + 1, 0);
+    vector<size_t> chunk_num_members(num_threads + 1, 0);
+    detail::parallel_chunks(parents.size(), num_threads, [&](size_t t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (parents[i] == i) {
+                chunk_num_groups[t + 1]++;
+                chunk_num_members[t + 1] += sizes[i];
+            }
+        }
+    });
+    for (size_t t = 0; t < num_threads; t++) {
+        chunk_num_groups[t + 1] += chunk_num_groups[t];
+        chunk_num_members[t + 1] += chunk_num_members[t];
+    }
+    
+    groups.offsets.resize(chunk_num_groups.back() + 1);
+    groups.offsets.back() = parents.size();
+    vector<size_t> heads(parents.size());
+    vector<size_t> members_buffer(parents.size());
+    vector<size_t> heads_buffer(parents.size());
+    detail::parallel_chunks(parents.size(), num_threads, [&](size_t t, size_t begin, size_t end) {
+        size_t group_idx = chunk_num_groups[t];
+        size_t group_begin = chunk_num_members[t];
+        for (size_t i = begin; i < end; i++) {
+            if (parents[i] == i) {
+                groups.offsets[group_idx++] = group_begin;
+                group_begin += sizes[i];
+            }
+            // finding without compressing does not write, so the threads cannot interfere
+            heads[i] = find_group_const(i);
+            groups.members[i] = i;
+        }
+    });
+    
+    // place the members with a least significant digit radix sort on their heads, which is
+    // stable, so the members stay in ascending order within each group
+    const size_t digit_width = 12;
+    const size_t num_buckets = size_t(1) << digit_width;
+    vector<size_t> bucket_begins(num_threads * num_buckets);
+    size_t max_head = parents.size() == 0 ? 0 : parents.size() - 1;
+    for (size_t shift = 0; shift < 64 && (max_head >> shift) != 0; shift += digit_width) {
+        fill(bucket_begins.begin(), bucket_begins.end(), 0);
+        detail::parallel_chunks(parents.size(), num_threads, [&](size_t t, size_t begin, size_t end) {
+            size_t* counts = bucket_begins.data() + t * num_buckets;
+            for (size_t k = begin; k < end; k++) {
+                counts[(heads[k] >> shift) & (num_buckets - 1)]++;
+            }
+        });
+        // each bucket is filled by the threads in order, after all of the lower buckets
+        size_t bucket_begin = 0;
+        for (size_t b = 0; b < num_buckets; b++) {
+            for (size_t t = 0; t < num_threads; t++) {
+                size_t count = bucket_begins[t * num_buckets + b];
+                bucket_begins[t * num_buckets + b] = bucket_begin;
+                bucket_begin += count;
+            }
+        }
+        detail::parallel_chunks(parents.size(), num_threads, [&](size_t t, size_t begin, size_t end) {
+            size_t* next_positions = bucket_begins.data() + t * num_buckets;
+            for (size_t k = begin; k < end; k++) {
+                size_t position = next_positions[(heads[k] >> shift) & (num_buckets - 1)]++;
+                heads_buffer[position] = heads[k];
+                members_buffer[position] = groups.members[k];
+            }
+        });
+        heads.swap(heads_buffer);
+        groups.members.swap(members_buffer);
+    }
+    
+    return groups;
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+vector<size_t> BasicUnionFind<Index, FindPolicy, CountWork>::parent_forest() {
+    vector<size_t> forest(parents.size());
+    for (size_t i = 0; i < parents.size(); i++) {
+        forest[i] = find_group(i);
+    }
+    return forest;
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+void BasicUnionFind<Index, FindPolicy, CountWork>::merge_from(const BasicUnionFind& other, const vector<size_t>& index_map) {
+    // the other's trees connect each of its groups, whether or not they are compressed
+    merge_parents(other.parents.data(), other.parents.size(), index_map);
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+void BasicUnionFind<Index, FindPolicy, CountWork>::merge_from_forest(const vector<size_t>& forest,
+                                                          const vector<size_t>& index_map) {
+    merge_parents(forest.data(), forest.size(), index_map);
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+template <typename ForestIndex>
+void BasicUnionFind<Index, FindPolicy, CountWork>::merge_parents(const ForestIndex* forest, size_t size,
+                                                      const vector<size_t>& index_map) {
+    assert(index_map.empty() || index_map.size() == size);
+    for (size_t k = 0; k < size; k++) {
+        assert(forest[k] < size);
+        if (forest[k] != k) {
+            if (index_map.empty()) {
+                union_groups(k, forest[k]);
+            }
+            else {
+                union_groups(index_map[k], index_map[forest[k]]);
+            }
+        }
+    }
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+bool BasicUnionFind<Index, FindPolicy, CountWork>::save(const string& path) {
+    FileHeader header;
+    memcpy(header.magic, "UNIONFND", sizeof(header.magic));
+    header.version = file_version;
+    header.index_width = sizeof(Index);
+    header.size = parents.size();
+    header.num_groups = group_count;
+    for (size_t k = 0; k < 64; k++) {
+        header.size_histogram[k] = size_histogram[k];
+    }
+    
+    vector<pair<const void*, size_t>> blocks {
+        make_pair(&header, sizeof(header)),
+        make_pair(parents.data(), parents.size() * sizeof(Index)),
+        make_pair(sizes.data(), sizes.size() * sizeof(Index)),
+        make_pair(next_members.data(), next_members.size() * sizeof(Index)),
+        make_pair(ranks.data(), ranks.size() * sizeof(uint8_t))
+    };
+    return detail::write_blocks(path, blocks);
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+bool BasicUnionFind<Index, FindPolicy, CountWork>::load(const string& path) {
+    // a private mapping gives us our own copy of any page that we write to
+    size_t file_size = 0;
+    shared_ptr<void> mapping = detail::map_file_private(path, file_size);
+    if (!mapping || file_size < sizeof(FileHeader)) {
+        return false;
+    }
+    void* mapped = mapping.get();
+    
+    const FileHeader* header = reinterpret_cast<const FileHeader*>(mapped);
+    if (memcmp(header->magic, "UNIONFND", sizeof(header->magic)) != 0
+        || header->version != file_version || header->index_width != sizeof(Index)) {
+        return false;
+    }
+    size_t size = header->size;
+    size_t element_width = 3 * sizeof(Index) + sizeof(uint8_t);
+    if (size > (file_size - sizeof(FileHeader)) / element_width
+        || file_size != sizeof(FileHeader) + size * element_width) {
+        return false;
+    }
+    
+    // the header keeps the arrays of indices aligned
+    Index* arrays = reinterpret_cast<Index*>(reinterpret_cast<char*>(mapped) + sizeof(FileHeader));
+    
+    // make sure that following the parents and member lists can never leave the arrays
+    for (size_t i = 0; i < size; i++) {
+        Index parent = arrays[i];
+        Index next_member = arrays[2 * size + i];
+        if (parent >= size || next_member >= size
+            || (parent == i && (arrays[size + i] == 0 || arrays[size + i] > size))) {
+            return false;
+        }
+    }
+    
+    parents = MappedArray<Index>(arrays, size, mapping);
+    sizes = MappedArray<Index>(arrays + size, size, mapping);
+    next_members = MappedArray<Index>(arrays + 2 * size, size, mapping);
+    ranks = MappedArray<uint8_t>(reinterpret_cast<uint8_t*>(arrays + 3 * size), size, mapping);
+    
+    group_count = header->num_groups;
+    for (size_t k = 0; k < 64; k++) {
+        size_histogram[k] = header->size_histogram[k];
+    }
+    
+    tracking_changes = false;
+    change_log.clear();
+    change_log_begin = 0;
+    
+    return true;
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+size_t BasicUnionFind<Index, FindPolicy, CountWork>::checkpoint() {
+    tracking_changes = true;
+    return change_log_begin + change_log.size();
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+vector<size_t> BasicUnionFind<Index, FindPolicy, CountWork>::changed_groups_since(size_t epoch) {
+    assert(epoch >= change_log_begin && epoch <= change_log_begin + change_log.size());
+    vector<size_t> to_return;
+    for (size_t k = epoch - change_log_begin; k < change_log.size(); k++) {
+        // the group may have been merged again since this change
+        to_return.push_back(find_group(change_log[k]));
+    }
+    sort(to_return.begin(), to_return.end());
+    to_return.resize(unique(to_return.begin(), to_return.end()) - to_return.begin());
+    return to_return;
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+void BasicUnionFind<Index, FindPolicy, CountWork>::discard_changes_before(size_t epoch) {
+    assert(epoch >= change_log_begin && epoch <= change_log_begin + change_log.size());
+    change_log.erase(change_log.begin(), change_log.begin() + (epoch - change_log_begin));
+    change_log_begin = epoch;
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+const UnionFindStats& BasicUnionFind<Index, FindPolicy, CountWork>::stats() const {
+    return counters;
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+void BasicUnionFind<Index, FindPolicy, CountWork>::reset_stats() {
+    counters = UnionFindStats();
+}
+
+template <typename Index, typename FindPolicy, bool CountWork>
+vector<size_t> BasicUnionFind<Index, FindPolicy, CountWork>::rank_distribution() const {
+    vector<size_t> to_return;
+    for (size_t i = 0; i < parents.size(); i++) {
+        if (parents[i] == i) {
+            if (to_return.size() <= ranks[i]) {
+                to_return.resize(ranks[i] + 1, 0);
+            }
+            to_return[ranks[i]]++;
+        }
+    }
+    return to_return;
+}
+
 }
 
 #endif /* structures_union_find_hpp */
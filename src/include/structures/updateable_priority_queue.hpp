@@ -24,6 +24,7 @@
 #define structures_updateable_priority_queue_hpp
 
 #include <queue>
+#include <functional>
 #include <unordered_set>
 
 namespace structures {
@@ -0,0 +1,82 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+//  weighted_union_find.hpp
+//
+// Contains an implementation of a union-find that tracks the differences between its members
+//
+
+#ifndef structures_weighted_union_find_hpp
+#define structures_weighted_union_find_hpp
+
+#include <vector>
+#include <cstdint>
+
+namespace structures {
+
+using namespace std;
+
+/**
+ * A Union-Find data structure for systems of difference constraints x_i - x_j = d. Each
+ * index stores its offset from its parent, and the offsets are summed as paths are
+ * compressed, so the difference between any two indices in the same group can be found
+ * in near-constant time. A constraint that contradicts the existing ones is rejected.
+ */
+class WeightedUnionFind {
+public:
+    /// Construct WeightedUnionFind for this many indices
+    WeightedUnionFind(size_t size);
+    
+    /// Destructor
+    ~WeightedUnionFind();
+    
+    /// Returns the number of indices in the WeightedUnionFind
+    size_t size() const;
+    
+    /// Returns the group ID that index i belongs to (can change after calling union)
+    size_t find_group(size_t i);
+    
+    /// Adds the constraint x_i - x_j = difference, merging the groups containing index i
+    /// and index j. Returns false without changing anything if the indices are already in
+    /// the same group with a different difference, else true.
+    bool union_groups(size_t i, size_t j, int64_t difference);
+    
+    /// Returns x_i - x_j. Indices i and j must be in the same group.
+    int64_t diff(size_t i, size_t j);
+    
+    /// Returns the size of the group containing index i
+    size_t group_size(size_t i);
+    
+private:
+    
+    /// The parent of each index in its group's tree, which is itself for the head
+    vector<size_t> parents;
+    
+    /// The difference x_i - x_parent of each index from its parent
+    vector<int64_t> offsets;
+    
+    /// An upper bound on the height of each head's tree
+    vector<uint8_t> ranks;
+    
+    /// The size of each head's group (not maintained for other indices)
+    vector<size_t> sizes;
+};
+
+}
+
+#endif /* structures_weighted_union_find_hpp */
@@ -0,0 +1,121 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "structures/repeats.hpp"
+#include "structures/suffix_tree.hpp"
+
+#include <algorithm>
+
+namespace structures {
+
+using namespace std;
+
+// Both forward and backward extensions are LCE queries on the concatenation of the string
+// and its (complemented) reverse. The index of the character at i in the reverse half is
+// 2n - 1 - i, and extensions in the reverse half are naturally capped by the terminator.
+
+vector<Run> find_runs(const string& str) {
+    return find_runs(str.data(), str.data() + str.size());
+}
+
+vector<Run> find_runs(const char* begin, const char* end) {
+    
+    vector<Run> runs;
+    
+    size_t n = end - begin;
+    string doubled(begin, end);
+    doubled.append(reverse_iterator<const char*>(end), reverse_iterator<const char*>(begin));
+    
+    SuffixTree suffix_tree(doubled.begin(), doubled.end());
+    
+    // a run with period p is at least 2p long, so it contains a pair of positions i and i + p
+    // where i is a multiple of p, and we can find the run by extending outward from them
+    for (size_t p = 1; 2 * p <= n; p++) {
+        for (size_t i = 0; i + p < n; i += p) {
+            size_t forward = min(suffix_tree.longest_common_extension(i, i + p), n - i - p);
+            size_t backward = i == 0 ? 0 : suffix_tree.longest_common_extension(2 * n - i, 2 * n - i - p);
+            // only report the run from the first sample position inside of it
+            if (forward + backward >= p && backward < p) {
+                runs.push_back(Run{i - backward, i + p + forward, p});
+            }
+        }
+    }
+    
+    // a run with smallest period p is also found with each multiple of p, but with
+    // the same interval, so we keep only the smallest period
+    sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) {
+        return a.begin < b.begin || (a.begin == b.begin && (a.end < b.end || (a.end == b.end && a.period < b.period)));
+    });
+    auto new_end = unique(runs.begin(), runs.end(), [](const Run& a, const Run& b) {
+        return a.begin == b.begin && a.end == b.end;
+    });
+    runs.erase(new_end, runs.end());
+    
+    return runs;
+}
+
+vector<InvertedRepeat> find_palindromes(const string& str, size_t min_arm_length) {
+    return find_palindromes(str.data(), str.data() + str.size(), min_arm_length);
+}
+
+vector<InvertedRepeat> find_palindromes(const char* begin, const char* end, size_t min_arm_length) {
+    // odd length palindromes have their middle character as a spacer
+    return find_inverted_repeats(begin, end, [](char c) { return c; }, 1, min_arm_length);
+}
+
+vector<InvertedRepeat> find_inverted_repeats(const string& str, const function<char(char)>& complement,
+                                             size_t max_spacer_length, size_t min_arm_length) {
+    return find_inverted_repeats(str.data(), str.data() + str.size(), complement,
+                                 max_spacer_length, min_arm_length);
+}
+
+vector<InvertedRepeat> find_inverted_repeats(const char* begin, const char* end,
+                                             const function<char(char)>& complement,
+                                             size_t max_spacer_length, size_t min_arm_length) {
+    
+    vector<InvertedRepeat> repeats;
+    
+    size_t n = end - begin;
+    string doubled(begin, end);
+    doubled.reserve(2 * n);
+    for (const char* iter = end; iter != begin; iter--) {
+        doubled.push_back(complement(*(iter - 1)));
+    }
+    
+    SuffixTree suffix_tree(doubled.begin(), doubled.end());
+    
+    // the left arm ends at i and the right arm begins after the spacer
+    for (size_t i = 0; i <= n; i++) {
+        for (size_t spacer = 0; spacer <= max_spacer_length && i + spacer <= n; spacer++) {
+            if (spacer >= 2 && *(begin + i + spacer - 1) == complement(*(begin + i))) {
+                // the arms can extend inward into the spacer, so this repeat is
+                // contained in one with a shorter spacer
+                continue;
+            }
+            size_t arm_length = min(suffix_tree.longest_common_extension(i + spacer, 2 * n - i),
+                                    n - i - spacer);
+            if (arm_length >= min_arm_length && arm_length > 0) {
+                repeats.push_back(InvertedRepeat{i - arm_length, i + spacer + arm_length, arm_length});
+            }
+        }
+    }
+    
+    return repeats;
+}
+
+}
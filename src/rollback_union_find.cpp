@@ -0,0 +1,111 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "structures/rollback_union_find.hpp"
+
+#include <cassert>
+#include <algorithm>
+
+namespace structures {
+
+using namespace std;
+
+RollbackUnionFind::RollbackUnionFind(size_t size) : parents(size), ranks(size, 0), sizes(size, 1),
+                                                    next_members(size) {
+    for (size_t i = 0; i < size; i++) {
+        parents[i] = i;
+        next_members[i] = i;
+    }
+}
+
+RollbackUnionFind::~RollbackUnionFind() {
+    // nothing to do
+}
+
+size_t RollbackUnionFind::size() const {
+    return parents.size();
+}
+
+size_t RollbackUnionFind::find_group(size_t i) const {
+    // no path compression, so that every union only changes the heads
+    while (parents[i] != i) {
+        i = parents[i];
+    }
+    return i;
+}
+
+void RollbackUnionFind::union_groups(size_t i, size_t j) {
+    size_t head_i = find_group(i);
+    size_t head_j = find_group(j);
+    if (head_i == head_j) {
+        // the indices are already in the same group
+        return;
+    }
+    
+    // use rank as a pivot to determine which group to make the head
+    if (ranks[head_i] > ranks[head_j]) {
+        swap(head_i, head_j);
+    }
+    bool rank_increased = (ranks[head_i] == ranks[head_j]);
+    parents[head_i] = head_j;
+    sizes[head_j] += sizes[head_i];
+    if (rank_increased) {
+        ranks[head_j]++;
+    }
+    // exchanging successors splices the two circular member lists into one
+    swap(next_members[head_i], next_members[head_j]);
+    
+    links.push_back(Link{head_i, head_j, rank_increased});
+}
+
+size_t RollbackUnionFind::group_size(size_t i) const {
+    return sizes[find_group(i)];
+}
+
+vector<size_t> RollbackUnionFind::group(size_t i) const {
+    vector<size_t> to_return;
+    // walk around the circular list of members
+    size_t curr = i;
+    do {
+        to_return.push_back(curr);
+        curr = next_members[curr];
+    } while (curr != i);
+    return to_return;
+}
+
+size_t RollbackUnionFind::checkpoint() const {
+    return links.size();
+}
+
+void RollbackUnionFind::rollback_to(size_t checkpoint) {
+    assert(checkpoint <= links.size());
+    while (links.size() > checkpoint) {
+        // undo the most recent union, which left both groups' heads where they were
+        const Link& link = links.back();
+        parents[link.child] = link.child;
+        sizes[link.parent] -= sizes[link.child];
+        if (link.rank_increased) {
+            ranks[link.parent]--;
+        }
+        // exchanging the successors again splits the member lists back apart
+        swap(next_members[link.child], next_members[link.parent]);
+        links.pop_back();
+    }
+}
+
+}
@@ -0,0 +1,399 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "structures/sliding_suffix_tree.hpp"
+
+#include <cassert>
+
+namespace structures {
+
+using namespace std;
+
+// The construction is Ukkonen's algorithm without a terminator, so the suffixes that
+// occur elsewhere in the window stay implicit. Deletion and the maintenance of edge labels
+// follow N. J. Larsson (1996), "Extended application of suffix trees to data compression".
+SlidingSuffixTree::SlidingSuffixTree(size_t window_size) : buffer(window_size), leaf_of(window_size) {
+    assert(window_size > 0);
+    // make the root
+    nodes.emplace_back();
+}
+
+size_t SlidingSuffixTree::size() const {
+    return back - front;
+}
+
+size_t SlidingSuffixTree::window_size() const {
+    return buffer.size();
+}
+
+size_t SlidingSuffixTree::front_position() const {
+    return front;
+}
+
+size_t SlidingSuffixTree::end_position() const {
+    return back;
+}
+
+char SlidingSuffixTree::at(size_t i) const {
+    assert(i >= front && i < back);
+    return get_char(i);
+}
+
+size_t SlidingSuffixTree::new_node(size_t parent, int64_t depth, size_t position, bool leaf) {
+    size_t node;
+    if (free_nodes.empty()) {
+        node = nodes.size();
+        nodes.emplace_back();
+    }
+    else {
+        node = free_nodes.back();
+        free_nodes.pop_back();
+    }
+    SWNode& n = nodes[node];
+    n.parent = parent;
+    n.depth = depth;
+    n.position = position;
+    n.suffix_link = 0;
+    n.credit = false;
+    n.leaf = leaf;
+    return node;
+}
+
+void SlidingSuffixTree::canonize() {
+    while (active_length > 0) {
+        size_t edge = active_edge();
+        int64_t edge_len = label_length(edge);
+        if (active_length < edge_len) {
+            break;
+        }
+        // the active point is at or below the end of the edge, so hop to the next node
+        active_node = edge;
+        active_length -= edge_len;
+    }
+}
+
+void SlidingSuffixTree::advance_active_point() {
+    if (active_node == 0) {
+        if (active_length > 0) {
+            // walk the beginning of the suffix ahead
+            active_length--;
+        }
+    }
+    else {
+        // the suffix link is one character shallower
+        active_node = nodes[active_node].suffix_link;
+    }
+    canonize();
+}
+
+void SlidingSuffixTree::update_position(size_t node, size_t position) {
+    while (node != 0) {
+        SWNode& n = nodes[node];
+        if (position > n.position) {
+            n.position = position;
+        }
+        n.credit = !n.credit;
+        if (n.credit) {
+            // hold onto the position until we receive another one
+            return;
+        }
+        // we already had a credit, so spend it by sending our freshest position upward
+        position = n.position;
+        node = n.parent;
+    }
+}
+
+void SlidingSuffixTree::append(char c) {
+    
+    if (size() == window_size()) {
+        expire_front();
+    }
+    
+    buffer[back % buffer.size()] = c;
+    back++;
+    remaining++;
+    
+    // the most recent internal node that is waiting for a suffix link
+    size_t prev_internal_node = 0;
+    
+    while (remaining > 0) {
+        // the suffix we are trying to add begins at this position
+        size_t suffix_begin = back - remaining;
+        
+        if (active_length == 0) {
+            SWNode& branch_point = nodes[active_node];
+            if (branch_point.children.count(c)) {
+                // there is an implicit match from the branch point, so this suffix and
+                // all shorter ones are already in the tree
+                if (prev_internal_node) {
+                    nodes[prev_internal_node].suffix_link = active_node;
+                }
+                active_length = 1;
+                canonize();
+                return;
+            }
+            
+            // add a leaf for this suffix
+            size_t leaf = new_node(active_node, 0, suffix_begin, true);
+            nodes[active_node].children[c] = leaf;
+            leaf_of[suffix_begin % leaf_of.size()] = leaf;
+            update_position(active_node, suffix_begin);
+            
+            if (prev_internal_node) {
+                nodes[prev_internal_node].suffix_link = active_node;
+                prev_internal_node = 0;
+            }
+        }
+        else {
+            size_t edge = active_edge();
+            size_t edge_begin = label_begin(edge);
+            if (get_char(edge_begin + active_length) == c) {
+                // there is an implicit match along the edge
+                if (prev_internal_node) {
+                    nodes[prev_internal_node].suffix_link = active_node;
+                }
+                active_length++;
+                canonize();
+                return;
+            }
+            
+            // split the edge with a new internal node, which inherits the new suffix's
+            // position as an occurrence of its string
+            int64_t split_depth = nodes[active_node].depth + active_length;
+            size_t split = new_node(active_node, split_depth, suffix_begin, false);
+            nodes[active_node].children[get_char(edge_begin)] = split;
+            nodes[split].children[get_char(edge_begin + active_length)] = edge;
+            nodes[edge].parent = split;
+            
+            // add a leaf below it for this suffix
+            size_t leaf = new_node(split, 0, suffix_begin, true);
+            nodes[split].children[c] = leaf;
+            leaf_of[suffix_begin % leaf_of.size()] = leaf;
+            update_position(split, suffix_begin);
+            
+            if (prev_internal_node) {
+                nodes[prev_internal_node].suffix_link = split;
+            }
+            prev_internal_node = split;
+        }
+        
+        remaining--;
+        advance_active_point();
+    }
+}
+
+void SlidingSuffixTree::expire_front() {
+    
+    assert(size() > 0);
+    
+    // the longest suffix cannot occur anywhere else in the window, so it always has a leaf
+    size_t leaf = leaf_of[front % leaf_of.size()];
+    size_t parent = nodes[leaf].parent;
+    
+    if (active_length > 0 && active_node == parent && active_edge() == leaf) {
+        // the longest implicit suffix only occurs elsewhere inside the suffix we are removing,
+        // so rather than deleting the leaf we can give it to that suffix instead
+        size_t suffix_begin = back - remaining;
+        nodes[leaf].position = suffix_begin;
+        leaf_of[suffix_begin % leaf_of.size()] = leaf;
+        update_position(parent, suffix_begin);
+        
+        remaining--;
+        advance_active_point();
+    }
+    else {
+        // remove the leaf
+        nodes[parent].children.erase(get_char(label_begin(leaf)));
+        nodes[leaf].children.clear();
+        free_nodes.push_back(leaf);
+        
+        SWNode& p = nodes[parent];
+        if (parent != 0 && p.children.size() == 1) {
+            // the parent no longer branches, so splice it out and let its remaining child
+            // inherit its edge
+            size_t child = p.children.begin()->second;
+            size_t grandparent = p.parent;
+            nodes[grandparent].children[get_char(label_begin(parent))] = child;
+            nodes[child].parent = grandparent;
+            
+            if (active_node == parent) {
+                // express the active point relative to the grandparent
+                active_length += p.depth - nodes[grandparent].depth;
+                active_node = grandparent;
+            }
+            
+            if (p.credit) {
+                // pass along the position we were holding before it's lost
+                update_position(grandparent, p.position);
+            }
+            
+            p.children.clear();
+            free_nodes.push_back(parent);
+        }
+    }
+    
+    front++;
+}
+
+vector<int64_t> SlidingSuffixTree::failure_function(string::const_iterator begin,
+                                                     string::const_iterator end) const {
+    // the length of the longest proper border of each prefix of the string
+    vector<int64_t> failure(end - begin + 1, 0);
+    if (begin == end) {
+        return failure;
+    }
+    failure[0] = -1;
+    int64_t border = -1;
+    for (int64_t i = 0; i < end - begin; i++) {
+        while (border >= 0 && *(begin + border) != *(begin + i)) {
+            border = failure[border];
+        }
+        border++;
+        failure[i + 1] = border;
+    }
+    return failure;
+}
+
+bool SlidingSuffixTree::find_locus(string::const_iterator begin, string::const_iterator end,
+                                   size_t& locus) {
+    
+    size_t node = 0;
+    auto iter = begin;
+    while (iter != end) {
+        // check for match on the first position on a node using the edges
+        auto found = nodes[node].children.find(*iter);
+        if (found == nodes[node].children.end()) {
+            return false;
+        }
+        node = found->second;
+        
+        // check for matches along the rest of the edge
+        size_t edge_begin = label_begin(node);
+        int64_t edge_len = label_length(node);
+        for (int64_t i = 0; i < edge_len && iter != end; i++, iter++) {
+            if (*iter != get_char(edge_begin + i)) {
+                return false;
+            }
+        }
+    }
+    locus = node;
+    return true;
+}
+
+size_t SlidingSuffixTree::longest_overlap(const string& str) {
+    return longest_overlap(str.begin(), str.end());
+}
+
+size_t SlidingSuffixTree::longest_overlap(string::const_iterator begin, string::const_iterator end) {
+    
+    // the explicit suffixes end at leaves, so follow the string down the tree and see whether
+    // it runs out at the very end of a leaf
+    size_t node = 0;
+    auto iter = begin;
+    while (iter != end) {
+        auto found = nodes[node].children.find(*iter);
+        if (found == nodes[node].children.end()) {
+            break;
+        }
+        node = found->second;
+        
+        size_t edge_begin = label_begin(node);
+        int64_t edge_len = label_length(node);
+        int64_t i = 0;
+        for (; i < edge_len && iter != end; i++, iter++) {
+            if (*iter != get_char(edge_begin + i)) {
+                break;
+            }
+        }
+        if (i < edge_len) {
+            break;
+        }
+        if (nodes[node].leaf) {
+            // we matched the entire suffix, and every other explicit suffix is shorter
+            return iter - begin;
+        }
+    }
+    
+    // the implicit suffixes all lie within the last remaining characters, so find the longest
+    // prefix of the string that is a suffix of them using KMP
+    if (begin == end) {
+        return 0;
+    }
+    vector<int64_t> failure = failure_function(begin, end);
+    int64_t matched = 0;
+    for (size_t i = back - remaining; i < back; i++) {
+        if (matched == end - begin) {
+            matched = failure[matched];
+        }
+        while (matched >= 0 && *(begin + matched) != get_char(i)) {
+            matched = failure[matched];
+        }
+        matched++;
+    }
+    return matched;
+}
+
+vector<size_t> SlidingSuffixTree::substring_locations(const string& str) {
+    return substring_locations(str.begin(), str.end());
+}
+
+vector<size_t> SlidingSuffixTree::substring_locations(string::const_iterator begin,
+                                                      string::const_iterator end) {
+    
+    vector<size_t> locations;
+    
+    // ensure that we don't try to match empty string (else it matches everywhere)
+    size_t locus;
+    if (end <= begin || size_t(end - begin) > size() || !find_locus(begin, end, locus)) {
+        return locations;
+    }
+    
+    // every leaf below the locus is an explicit suffix that begins with the string
+    vector<size_t> stack(1, locus);
+    while (!stack.empty()) {
+        const SWNode& node = nodes[stack.back()];
+        stack.pop_back();
+        if (node.leaf) {
+            locations.push_back(node.position);
+        }
+        else {
+            for (const auto& edge : node.children) {
+                stack.push_back(edge.second);
+            }
+        }
+    }
+    
+    // the implicit suffixes don't have leaves, so we check for occurrences among them directly
+    vector<int64_t> failure = failure_function(begin, end);
+    int64_t len = end - begin;
+    int64_t matched = 0;
+    for (size_t i = back - remaining; i < back; i++) {
+        while (matched >= 0 && *(begin + matched) != get_char(i)) {
+            matched = failure[matched];
+        }
+        matched++;
+        if (matched == len) {
+            locations.push_back(i + 1 - len);
+            matched = failure[matched];
+        }
+    }
+    
+    return locations;
+}
+    
+}
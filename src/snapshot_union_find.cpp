@@ -0,0 +1,61 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "structures/snapshot_union_find.hpp"
+
+namespace structures {
+
+using namespace std;
+
+SnapshotUnionFind::SnapshotUnionFind(size_t size) : writer(size) {
+    publish();
+}
+
+SnapshotUnionFind::~SnapshotUnionFind() {
+    // nothing to do
+}
+
+size_t SnapshotUnionFind::size() const {
+    return writer.size();
+}
+
+size_t SnapshotUnionFind::add_element() {
+    return writer.add_element();
+}
+
+size_t SnapshotUnionFind::find_group(size_t i) {
+    return writer.find_group(i);
+}
+
+void SnapshotUnionFind::union_groups(size_t i, size_t j) {
+    writer.union_groups(i, j);
+}
+
+void SnapshotUnionFind::publish() {
+    // point every index directly at its head so that the readers' finds take one step, and
+    // only copy what the const queries use
+    writer.compact();
+    shared_ptr<const UnionFind> copy = make_shared<UnionFind>(writer.copy_groups());
+    atomic_store(&published, copy);
+}
+
+shared_ptr<const UnionFind> SnapshotUnionFind::snapshot() const {
+    return atomic_load(&published);
+}
+
+}
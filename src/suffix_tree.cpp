@@ -18,22 +18,64 @@
 
 #include "structures/suffix_tree.hpp"
 
+#include <tuple>
+#include <cassert>
+
+#ifdef STRUCTURES_SUFFIX_TREE_STATS
+#define SUFFIX_TREE_STAT(counter) (counters.counter++)
+#else
+#define SUFFIX_TREE_STAT(counter)
+#endif
+
 namespace structures {
 
 using namespace std;
 
+// estimate of the heap allocations of a hash table, which are an array of buckets and
+// a singly-linked node for each entry
+template<typename Key, typename Value>
+static size_t hash_table_bytes(const unordered_map<Key, Value>& table) {
+    return table.bucket_count() * sizeof(void*)
+        + table.size() * (sizeof(typename unordered_map<Key, Value>::value_type) + sizeof(void*));
+}
+
+// the address of the first char in a range, which may be empty
+static inline const char* char_range_begin(string::const_iterator begin, string::const_iterator end) {
+    return begin == end ? nullptr : &(*begin);
+}
+
+const int SuffixTree::terminator;
+
+inline SuffixTree::STNode* SuffixTree::find_child(unordered_map<int, STNode*>& branch_point, int c) {
+    SUFFIX_TREE_STAT(child_lookups);
+    auto iter = branch_point.find(c);
+    return iter == branch_point.end() ? nullptr : iter->second;
+}
+
+SuffixTree::SuffixTree(string::const_iterator begin, string::const_iterator end) :
+SuffixTree(char_range_begin(begin, end), char_range_begin(begin, end) + (end - begin))
+{
+    // nothing to do
+}
+
+SuffixTree::SuffixTree(const uint8_t* begin, const uint8_t* end) :
+SuffixTree(reinterpret_cast<const char*>(begin), reinterpret_cast<const char*>(end))
+{
+    // nothing to do
+}
+
 // Ukkonen's construction algorithm, similar to implementation in
 // http://stackoverflow.com/questions/9452701/ukkonens-suffix-tree-algorithm-in-plain-english
-SuffixTree::SuffixTree(string::const_iterator begin, string::const_iterator end) :
+SuffixTree::SuffixTree(const char* begin, const char* end) :
 begin(begin), end(end)
 {
     
-    unordered_map<unordered_map<char, STNode*>*, unordered_map<char, STNode*>*> suffix_links;
+    unordered_map<unordered_map<int, STNode*>*, unordered_map<int, STNode*>*> suffix_links;
     
     // active "edge" in usual parlance
     STNode* active_node = nullptr;
     // active "node" in usual parlance
-    unordered_map<char, STNode*>* active_branch_point = &root;
+    unordered_map<int, STNode*>* active_branch_point = &root;
     
     // the next index to attempt to match on the current node (and possibly insert a new one)
     int active_length = 0;
@@ -63,10 +105,10 @@ begin(begin), end(end)
                 continue;
             }
         }
-        else if (active_branch_point->count(get_char(i))) {
+        else if (STNode* next_node = find_child(*active_branch_point, get_char(i))) {
             // the active position is at a branch point and it has an edge that
             // matches
-            active_node = active_branch_point->at(get_char(i));
+            active_node = next_node;
             if (active_node->length(i) == 1) {
                 active_branch_point = &(active_node->children);
                 active_node = nullptr;
@@ -82,7 +124,7 @@ begin(begin), end(end)
         // there are no more implicit matches to work through, add the
         // remaining suffixes we've accumulated
         
-        unordered_map<char, STNode*>* prev_internal_branch_point = nullptr;
+        unordered_map<int, STNode*>* prev_internal_branch_point = nullptr;
         while (remaining > 0) {
             
             // traverse downward if necessary
@@ -100,17 +142,18 @@ begin(begin), end(end)
                         break;
                     }
                     
-                    active_node = active_branch_point->at(get_char(i - active_length));
+                    active_node = find_child(*active_branch_point, get_char(i - active_length));
                     node_len = active_node->length(i);
                 }
             }
             
             if (!active_node) {
-                if (active_branch_point->count(get_char(i))) {
+                STNode* next_node = find_child(*active_branch_point, get_char(i));
+                if (next_node) {
                     // there is a node from the branch point that starts with the right
                     // sequence, identify it as the active node and then continue the iteration
                     // so that it gets identified as an implicit match
-                    active_node = active_branch_point->at(get_char(i));
+                    active_node = next_node;
                 }
                 else {
                     // there is no node from this branch point starting with the right
@@ -132,6 +175,7 @@ begin(begin), end(end)
                     
                     if (suffix_links.count(active_branch_point)) {
                         active_branch_point = suffix_links[active_branch_point];
+                        SUFFIX_TREE_STAT(suffix_link_hops);
                     }
                     else {
                         active_branch_point = &root;
@@ -166,6 +210,7 @@ begin(begin), end(end)
                 }
                 
                 // create a new node for the first part of active node
+                SUFFIX_TREE_STAT(node_splits);
                 nodes.emplace_back(active_node->first, active_node->first + active_length - 1);
                 STNode* new_beginning_node = &nodes.back();
                 // rewire the edge from the parent branch point
@@ -199,40 +244,26 @@ begin(begin), end(end)
                     // we are already at the root, so walk the beginning of the suffix ahead
                     // and update the active point accordingly
                     active_length--;
-                    char active_node_begin;
+                    int active_node_begin;
                     if (active_node->length(i) > 1) {
                         active_node_begin = get_char(active_node->first + 1);
                     }
                     else {
                         active_node_begin = get_char(new_end_node->first);
                     }
-                    if (active_branch_point->count(active_node_begin)) {
-                        active_node = active_branch_point->at(active_node_begin);
-                    }
-                    else {
-                        active_node = nullptr;
-                    }
+                    active_node = find_child(*active_branch_point, active_node_begin);
                 }
                 else if (suffix_links.count(active_branch_point)) {
                     // there is a suffix link, so we can walk to the next suffix using that
                     active_branch_point = suffix_links[active_branch_point];
-                    if (active_branch_point->count(get_char(active_node->first))) {
-                        active_node = active_branch_point->at(get_char(active_node->first));
-                    }
-                    else {
-                        active_node = nullptr;
-                    }
+                    SUFFIX_TREE_STAT(suffix_link_hops);
+                    active_node = find_child(*active_branch_point, get_char(active_node->first));
                 }
                 else {
                     // we are newly moving to the root, which is the same as taking a suffix
                     // link to it
                     active_branch_point = &root;
-                    if (active_branch_point->count(get_char(active_node->first))) {
-                        active_node = active_branch_point->at(get_char(active_node->first));
-                    }
-                    else {
-                        active_node = nullptr;
-                    }
+                    active_node = find_child(*active_branch_point, get_char(active_node->first));
                 }
             }
             
@@ -241,6 +272,8 @@ begin(begin), end(end)
         }
     }
     
+    construction_suffix_link_bytes = hash_table_bytes(suffix_links);
+    
     // initialize DFS stack
     list<STNode*> stack;
     for (const auto& edge : root) {
@@ -268,11 +301,15 @@ size_t SuffixTree::longest_overlap(const string& str) {
 }
 
 size_t SuffixTree::longest_overlap(string::const_iterator begin, string::const_iterator end) {
+    return longest_overlap(char_range_begin(begin, end), char_range_begin(begin, end) + (end - begin));
+}
+
+size_t SuffixTree::longest_overlap(const char* begin, const char* end) {
     
     size_t overlap = 0;
     
     STNode* node = nullptr;
-    unordered_map<char, STNode*>* branch_point = &root;
+    unordered_map<int, STNode*>* branch_point = &root;
     
     size_t node_idx = 0;
     size_t str_idx = 0;
@@ -280,12 +317,15 @@ size_t SuffixTree::longest_overlap(string::const_iterator begin, string::const_i
     for (auto iter = begin; iter <= end; iter++, str_idx++) {
         if (branch_point) {
             // check if the prefix thus far is a suffix
-            if (branch_point->count('\0')) {
+            if (find_child(*branch_point, terminator)) {
                 overlap = str_idx;
             }
+            if (iter == end) {
+                break;
+            }
             // check for match on the first position on a node using the edges
-            if (branch_point->count(*iter)) {
-                node = branch_point->at(*iter);
+            if (STNode* next_node = find_child(*branch_point, symbol(*iter))) {
+                node = next_node;
                 branch_point = nullptr;
                 node_idx = 1;
             }
@@ -298,16 +338,16 @@ size_t SuffixTree::longest_overlap(string::const_iterator begin, string::const_i
             if (iter == end) {
                 // we've run out of string to find matches for but this could be
                 // an overlap if we're at the end of of the suffix tree string too
-                if (get_char(node->first + node_idx) == '\0') {
+                if (get_char(node->first + node_idx) == terminator) {
                     overlap = str_idx;
                 }
             }
             else {
-                if (*iter == get_char(node->first + node_idx)) {
+                if (symbol(*iter) == get_char(node->first + node_idx)) {
                     // we match here
                     node_idx++;
                 }
-                else if (get_char(node->first + node_idx) == '\0') {
+                else if (get_char(node->first + node_idx) == terminator) {
                     // we've matched the entire string, this is a leaf
                     overlap = str_idx;
                     break;
@@ -328,52 +368,32 @@ size_t SuffixTree::longest_overlap(string::const_iterator begin, string::const_i
     return overlap;
 }
 
-vector<size_t> SuffixTree::substring_locations(const string& str) {
-    return substring_locations(str.begin(), str.end());
-}
-
-vector<size_t> SuffixTree::substring_locations(string::const_iterator begin, string::const_iterator end) {
-    
-    vector<size_t> locations;
-    
-    
-    size_t str_len = this->end - this->begin;
-    size_t substr_len = end - begin;
-    
-    // ensure that we will never have an index beyond end of the suffix tree string
-    // or try to match empty string (else it matches everywhere)
-    if (substr_len > str_len || end <= begin) {
-        return locations;
-    }
+SuffixTree::STNode* SuffixTree::find_locus(const char* begin, const char* end, size_t& node_idx) {
     
     STNode* node = nullptr;
-    unordered_map<char, STNode*>* branch_point = &root;
-    size_t node_idx = 0;
-    
-    bool found_match = true;
+    unordered_map<int, STNode*>* branch_point = &root;
+    node_idx = 0;
     
     // look for a match of the entirety of the query string
     for (auto iter = begin; iter != end; iter++) {
         if (branch_point) {
             // check for match on the first position on a node using the edges
-            if (branch_point->count(*iter)) {
-                node = branch_point->at(*iter);
+            if (STNode* next_node = find_child(*branch_point, symbol(*iter))) {
+                node = next_node;
                 branch_point = nullptr;
                 node_idx = 1;
             }
             else {
-                found_match = false;
-                break;
+                return nullptr;
             }
         }
         else {
             // check for match on the current position along a node
-            if (*iter == get_char(node->first + node_idx)) {
+            if (symbol(*iter) == get_char(node->first + node_idx)) {
                 node_idx++;
             }
             else {
-                found_match = false;
-                break;
+                return nullptr;
             }
         }
         
@@ -383,11 +403,41 @@ vector<size_t> SuffixTree::substring_locations(string::const_iterator begin, str
         }
     }
     
-    if (found_match) {
+    return node;
+}
+
+vector<size_t> SuffixTree::substring_locations(const string& str) {
+    return substring_locations(str.begin(), str.end());
+}
+
+vector<size_t> SuffixTree::substring_locations(string::const_iterator begin, string::const_iterator end) {
+    return substring_locations(char_range_begin(begin, end),
+                               char_range_begin(begin, end) + (end - begin));
+}
+
+vector<size_t> SuffixTree::substring_locations(const char* begin, const char* end) {
+    
+    vector<size_t> locations;
+    
+    
+    size_t str_len = this->end - this->begin;
+    size_t substr_len = end - begin;
+    
+    // ensure that we will never have an index beyond end of the suffix tree string
+    // or try to match empty string (else it matches everywhere)
+    if (substr_len > str_len || end <= begin) {
+        return locations;
+    }
+    
+    size_t node_idx;
+    STNode* node = find_locus(begin, end, node_idx);
+    
+    if (node) {
         // we matched the entire query string, now traverse down the tree to find locations
         
         
         // edge case: there is only one location, so we are already on a leaf node
+        SUFFIX_TREE_STAT(dfs_nodes_visited);
         if (node->last == str_len) {
             locations.push_back(node->first + node_idx - substr_len);
             return locations;
@@ -398,7 +448,7 @@ vector<size_t> SuffixTree::substring_locations(string::const_iterator begin, str
         
         // initialize a stack with the next nodes down
         list<pair<STNode*, int64_t>> stack;
-        for (const pair<char, STNode*>& edge : node->children) {
+        for (const auto& edge : node->children) {
             stack.push_back(pair<STNode*, int64_t>(edge.second, depth_to_node_end));
         }
         
@@ -406,6 +456,7 @@ vector<size_t> SuffixTree::substring_locations(string::const_iterator begin, str
         while (!stack.empty()) {
             pair<STNode*, int64_t> path_head = stack.back();
             stack.pop_back();
+            SUFFIX_TREE_STAT(dfs_nodes_visited);
             
             if (path_head.first->last == str_len) {
                 // we are at a leaf, use it and the depth to figure out where the
@@ -422,7 +473,7 @@ vector<size_t> SuffixTree::substring_locations(string::const_iterator begin, str
                 STNode* head_node = path_head.first;
                 int64_t next_depth = path_head.second + head_node->last - head_node->first + 1;
                 
-                for (const pair<char, STNode*>& edge : path_head.first->children) {
+                for (const auto& edge : path_head.first->children) {
                     stack.push_back(pair<STNode*, int64_t>(edge.second, next_depth));
                 }
             }
@@ -432,6 +483,317 @@ vector<size_t> SuffixTree::substring_locations(string::const_iterator begin, str
     return locations;
 }
 
+vector<size_t> SuffixTree::sorted_substring_locations(const string& str, size_t window_begin,
+                                                      size_t window_end) {
+    return sorted_substring_locations(str.begin(), str.end(), window_begin, window_end);
+}
+
+vector<size_t> SuffixTree::sorted_substring_locations(string::const_iterator begin,
+                                                      string::const_iterator end,
+                                                      size_t window_begin, size_t window_end) {
+    return sorted_substring_locations(char_range_begin(begin, end),
+                                      char_range_begin(begin, end) + (end - begin),
+                                      window_begin, window_end);
+}
+
+vector<size_t> SuffixTree::sorted_substring_locations(const char* begin, const char* end,
+                                                      size_t window_begin, size_t window_end) {
+    
+    vector<size_t> locations;
+    
+    size_t str_len = this->end - this->begin;
+    size_t substr_len = end - begin;
+    
+    // ensure that we will never have an index beyond end of the suffix tree string
+    // or try to match empty string (else it matches everywhere)
+    if (substr_len > str_len || end <= begin || window_begin >= window_end) {
+        return locations;
+    }
+    
+    size_t node_idx;
+    STNode* node = find_locus(begin, end, node_idx);
+    if (node) {
+        if (!position_index) {
+            build_position_index();
+        }
+        // the leaves below the locus are exactly the occurrences
+        position_index->report(node->leaf_begin, node->leaf_end, window_begin, window_end, locations);
+    }
+    
+    return locations;
+}
+
+size_t SuffixTree::longest_common_extension(size_t i, size_t j) {
+    
+    size_t str_len = end - begin;
+    assert(i <= str_len && j <= str_len);
+    
+    if (i == j) {
+        return str_len - i;
+    }
+    if (adjacent_lcps.empty()) {
+        build_lce_index();
+    }
+    
+    // the LCP of two suffixes is the minimum LCP of the adjacent leaves between them
+    return min_adjacent_lcp(min(suffix_ranks[i], suffix_ranks[j]) + 1,
+                            max(suffix_ranks[i], suffix_ranks[j]) + 1);
+}
+
+// Minimum queries over the adjacent LCPs use blocks of 64 leaves. A query inside of a block
+// uses a mask of the leaves that are smaller than everything after them in the block so far,
+// and whole blocks are covered by a sparse table over the blocks' minimums, which only has
+// n / 64 entries per level.
+
+void SuffixTree::build_lce_index() {
+    
+    vector<size_t> positions;
+    order_leaves(positions, adjacent_lcps);
+    // the LCPs were appended one at a time, and we keep them for every query
+    adjacent_lcps.shrink_to_fit();
+    
+    suffix_ranks.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); i++) {
+        suffix_ranks[positions[i]] = i;
+    }
+    
+    size_t num_blocks = (adjacent_lcps.size() + 63) / 64;
+    lcp_block_masks.resize(adjacent_lcps.size());
+    vector<size_t> block_mins(num_blocks);
+    for (size_t block = 0; block < num_blocks; block++) {
+        size_t block_begin = block * 64;
+        size_t block_end = min(block_begin + 64, adjacent_lcps.size());
+        uint64_t mask = 0;
+        for (size_t i = block_begin; i < block_end; i++) {
+            // remove the leaves that are no smaller than this one, which are the highest bits
+            while (mask && adjacent_lcps[block_begin + 63 - __builtin_clzll(mask)] >= adjacent_lcps[i]) {
+                mask ^= uint64_t(1) << (63 - __builtin_clzll(mask));
+            }
+            mask |= uint64_t(1) << (i - block_begin);
+            lcp_block_masks[i] = mask;
+        }
+        // the lowest remaining leaf is the minimum of the whole block
+        block_mins[block] = adjacent_lcps[block_begin + __builtin_ctzll(mask)];
+    }
+    
+    // level k holds the minimum of each run of 2^k blocks
+    lcp_block_table.clear();
+    lcp_block_table.emplace_back(move(block_mins));
+    for (size_t width = 2; width <= num_blocks; width *= 2) {
+        const vector<size_t>& prev_level = lcp_block_table.back();
+        vector<size_t> level(num_blocks - width + 1);
+        for (size_t i = 0; i < level.size(); i++) {
+            level[i] = min(prev_level[i], prev_level[i + width / 2]);
+        }
+        lcp_block_table.emplace_back(move(level));
+    }
+}
+
+inline size_t SuffixTree::min_adjacent_lcp_in_block(size_t rank_begin, size_t rank_last) const {
+    // the lowest leaf at or after the beginning that is smaller than everything after it
+    uint64_t mask = lcp_block_masks[rank_last] & (~uint64_t(0) << (rank_begin % 64));
+    return adjacent_lcps[rank_last - rank_last % 64 + __builtin_ctzll(mask)];
+}
+
+size_t SuffixTree::min_adjacent_lcp(size_t rank_begin, size_t rank_end) const {
+    
+    size_t first_block = rank_begin / 64;
+    size_t last_block = (rank_end - 1) / 64;
+    if (first_block == last_block) {
+        return min_adjacent_lcp_in_block(rank_begin, rank_end - 1);
+    }
+    
+    size_t min_lcp = min(min_adjacent_lcp_in_block(rank_begin, first_block * 64 + 63),
+                         min_adjacent_lcp_in_block(last_block * 64, rank_end - 1));
+    if (last_block - first_block > 1) {
+        // the blocks in between are covered by two overlapping runs of the sparse table
+        size_t blocks_begin = first_block + 1;
+        size_t num_blocks = last_block - blocks_begin;
+        size_t level = 0;
+        while ((size_t(2) << level) <= num_blocks) {
+            level++;
+        }
+        min_lcp = min(min_lcp, min(lcp_block_table[level][blocks_begin],
+                                   lcp_block_table[level][last_block - (size_t(1) << level)]));
+    }
+    return min_lcp;
+}
+
+void SuffixTree::build_position_index() {
+    
+    vector<size_t> positions;
+    vector<size_t> leaf_lcps;
+    order_leaves(positions, leaf_lcps);
+    
+    position_index = unique_ptr<LeafPositionIndex>(new LeafPositionIndex(positions, end - begin));
+}
+
+void SuffixTree::order_leaves(vector<size_t>& positions, vector<size_t>& adjacent_lcps) {
+    
+    positions.clear();
+    adjacent_lcps.clear();
+    
+    // the shallowest depth we have branched from since the last leaf, which is the depth of
+    // its lowest common ancestor with the next leaf
+    int64_t branch_depth = 0;
+    
+    // DFS stack of nodes, the depth above them, and whether we have already added their children
+    vector<tuple<STNode*, int64_t, bool>> stack;
+    for (const auto& edge : root) {
+        stack.emplace_back(edge.second, 0, false);
+    }
+    
+    while (!stack.empty()) {
+        STNode* node = get<0>(stack.back());
+        int64_t depth = get<1>(stack.back());
+        if (get<2>(stack.back())) {
+            // we've finished all of this node's leaves
+            node->leaf_end = positions.size();
+            stack.pop_back();
+            continue;
+        }
+        
+        branch_depth = min(branch_depth, depth);
+        node->leaf_begin = positions.size();
+        if (node->children.empty()) {
+            // leaves extend to the end of the string, so we can find where the suffix begins
+            adjacent_lcps.push_back(positions.empty() ? 0 : branch_depth);
+            positions.push_back(node->first - depth);
+            node->leaf_end = positions.size();
+            stack.pop_back();
+            branch_depth = numeric_limits<int64_t>::max();
+        }
+        else {
+            get<2>(stack.back()) = true;
+            int64_t next_depth = depth + node->last - node->first + 1;
+            for (const auto& edge : node->children) {
+                stack.emplace_back(edge.second, next_depth, false);
+            }
+        }
+    }
+}
+
+SuffixTree::LeafPositionIndex::LeafPositionIndex(const vector<size_t>& positions, size_t max_position) {
+    
+    num_levels = 1;
+    while (num_levels < 64 && (max_position >> num_levels)) {
+        num_levels++;
+    }
+    
+    bits.resize(num_levels);
+    word_ranks.resize(num_levels);
+    num_zeros.resize(num_levels);
+    
+    // at each level, stably partition the values by their bit at that level
+    vector<size_t> values = positions, zeros, ones;
+    for (size_t level = 0; level < num_levels; level++) {
+        size_t shift = num_levels - level - 1;
+        vector<uint64_t>& level_bits = bits[level];
+        level_bits.resize(values.size() / 64 + 1, 0);
+        zeros.clear();
+        ones.clear();
+        for (size_t i = 0; i < values.size(); i++) {
+            if ((values[i] >> shift) & 1) {
+                level_bits[i / 64] |= uint64_t(1) << (i % 64);
+                ones.push_back(values[i]);
+            }
+            else {
+                zeros.push_back(values[i]);
+            }
+        }
+        num_zeros[level] = zeros.size();
+        
+        vector<size_t>& level_ranks = word_ranks[level];
+        level_ranks.resize(level_bits.size(), 0);
+        for (size_t i = 1; i < level_bits.size(); i++) {
+            level_ranks[i] = level_ranks[i - 1] + __builtin_popcountll(level_bits[i - 1]);
+        }
+        
+        values.clear();
+        values.insert(values.end(), zeros.begin(), zeros.end());
+        values.insert(values.end(), ones.begin(), ones.end());
+    }
+}
+
+void SuffixTree::LeafPositionIndex::report(size_t rank_begin, size_t rank_end,
+                                           size_t window_begin, size_t window_end,
+                                           vector<size_t>& out) const {
+    if (rank_begin < rank_end) {
+        report(0, 0, rank_begin, rank_end, window_begin, window_end, out);
+    }
+}
+
+void SuffixTree::LeafPositionIndex::report(size_t level, size_t prefix, size_t rank_begin, size_t rank_end,
+                                           size_t window_begin, size_t window_end,
+                                           vector<size_t>& out) const {
+    
+    // the range of values that can be below this point
+    size_t shift = num_levels - level;
+    size_t min_value = prefix << shift;
+    size_t max_value = min_value + ((size_t(1) << shift) - 1);
+    if (max_value < window_begin || min_value >= window_end) {
+        // none of them are in the window
+        return;
+    }
+    
+    if (level == num_levels) {
+        // every leaf in the range has this position
+        for (size_t i = rank_begin; i < rank_end; i++) {
+            out.push_back(prefix);
+        }
+        return;
+    }
+    
+    // the smaller values are partitioned to the front of the next level
+    size_t ones_begin = rank1(level, rank_begin);
+    size_t ones_end = rank1(level, rank_end);
+    if (rank_end - rank_begin > ones_end - ones_begin) {
+        report(level + 1, prefix << 1, rank_begin - ones_begin, rank_end - ones_end,
+               window_begin, window_end, out);
+    }
+    if (ones_end > ones_begin) {
+        report(level + 1, (prefix << 1) | 1, num_zeros[level] + ones_begin, num_zeros[level] + ones_end,
+               window_begin, window_end, out);
+    }
+}
+
+const SuffixTreeStats& SuffixTree::stats() const {
+    return counters;
+}
+
+void SuffixTree::reset_stats() {
+    counters = SuffixTreeStats();
+}
+
+SuffixTreeMemoryUsage SuffixTree::memory_usage() const {
+    SuffixTreeMemoryUsage usage;
+    // list entries also hold pointers to the previous and next entry, and this includes
+    // the nodes' leaf ranges for the position index
+    usage.nodes = nodes.size() * (sizeof(STNode) + 2 * sizeof(void*));
+    usage.edges = hash_table_bytes(root);
+    for (const STNode& node : nodes) {
+        usage.edges += hash_table_bytes(node.children);
+    }
+    usage.construction_suffix_links = construction_suffix_link_bytes;
+    usage.lce_index = (suffix_ranks.capacity() * sizeof(size_t) + adjacent_lcps.capacity() * sizeof(size_t)
+                       + lcp_block_masks.capacity() * sizeof(uint64_t));
+    for (const vector<size_t>& level : lcp_block_table) {
+        usage.lce_index += level.capacity() * sizeof(size_t);
+    }
+    if (position_index) {
+        usage.position_index = sizeof(LeafPositionIndex);
+        for (size_t level = 0; level < position_index->num_levels; level++) {
+            usage.position_index += (position_index->bits[level].capacity() * sizeof(uint64_t)
+                                     + position_index->word_ranks[level].capacity() * sizeof(size_t));
+        }
+    }
+    return usage;
+}
+
+size_t SuffixTreeMemoryUsage::total() const {
+    return nodes + edges + position_index + lce_index;
+}
+
 SuffixTree::STNode::STNode(int64_t first, int64_t last) : first(first), last(last) {
     // nothing to do
 }
@@ -28,11 +28,26 @@
 #include <algorithm>
 #include <queue>
 #include <unordered_map>
+#include <unordered_set>
 #include <random>
+#include <tuple>
 #include <cassert>
+#include <thread>
+#include <unistd.h>
 
 #include "structures/suffix_tree.hpp"
+#include "structures/sliding_suffix_tree.hpp"
+#include "structures/repeats.hpp"
 #include "structures/union_find.hpp"
+#include "structures/keyed_union_find.hpp"
+#include "structures/rollback_union_find.hpp"
+#include "structures/annotated_union_find.hpp"
+#include "structures/weighted_union_find.hpp"
+#include "structures/deletable_union_find.hpp"
+#include "structures/snapshot_union_find.hpp"
+#include "structures/concurrent_union_find.hpp"
+#include "structures/connected_components.hpp"
+#include "structures/single_linkage.hpp"
 #include "structures/min_max_heap.hpp"
 #include "structures/immutable_list.hpp"
 #include "structures/stable_double.hpp"
@@ -253,6 +268,117 @@ void test_suffix_tree_with_curated_examples() {
         
         assert(locs == correct_locs);
     }
+    {
+        
+        string seq = "AGTGCGATAGATGATAGAAGATCGCTCGCTCCGCGATA";
+        
+        SuffixTree suffix_tree(seq.begin(), seq.end());
+        
+        assert(suffix_tree.memory_usage().position_index == 0);
+        
+        vector<size_t> correct_locs {5, 12, 34};
+        assert(suffix_tree.sorted_substring_locations("GATA") == correct_locs);
+        
+        correct_locs = {12};
+        assert(suffix_tree.sorted_substring_locations("GATA", 6, 34) == correct_locs);
+        
+        correct_locs = {5, 12};
+        assert(suffix_tree.sorted_substring_locations("GATA", 5, 34) == correct_locs);
+        
+        assert(suffix_tree.sorted_substring_locations("GATA", 13, 34).empty());
+        assert(suffix_tree.sorted_substring_locations("GATA", 12, 12).empty());
+        assert(suffix_tree.sorted_substring_locations("GATT").empty());
+        assert(suffix_tree.sorted_substring_locations("").empty());
+        
+        string substr = "A";
+        assert(suffix_tree.sorted_substring_locations(substr) == substring_locations(seq, substr));
+        
+        assert(suffix_tree.memory_usage().position_index > 0);
+    }
+    {
+        
+        string seq = "ACACAGTACACG";
+        
+        SuffixTree suffix_tree(seq.begin(), seq.end());
+        
+        assert(suffix_tree.longest_common_extension(0, 2) == 3);
+        assert(suffix_tree.longest_common_extension(2, 0) == 3);
+        assert(suffix_tree.longest_common_extension(0, 7) == 4);
+        assert(suffix_tree.longest_common_extension(1, 3) == 2);
+        assert(suffix_tree.longest_common_extension(0, 1) == 0);
+        assert(suffix_tree.longest_common_extension(4, 4) == 8);
+        assert(suffix_tree.longest_common_extension(0, 12) == 0);
+        
+        assert(suffix_tree.memory_usage().lce_index > 0);
+    }
+    {
+        
+        // binary data, including nulls and bytes that are negative as chars
+        vector<uint8_t> seq {0, 255, 0, 0, 255, 7, 0, 255};
+        
+        SuffixTree suffix_tree(seq.data(), seq.data() + seq.size());
+        
+        assert(size_t(suffix_tree.end - suffix_tree.begin) == seq.size());
+        
+        string query("\0\xff", 2);
+        vector<size_t> locs = suffix_tree.substring_locations(query);
+        sort(locs.begin(), locs.end());
+        
+        vector<size_t> correct_locs {0, 3, 6};
+        assert(locs == correct_locs);
+        
+        const char* data = query.data();
+        assert(suffix_tree.sorted_substring_locations(data, data + query.size()) == correct_locs);
+        assert(suffix_tree.substring_locations(data, data + 1).size() == 4);
+        assert(suffix_tree.substring_locations(data + 1, data + 2).size() == 3);
+        
+        assert(suffix_tree.longest_overlap(query) == 2);
+        assert(suffix_tree.longest_overlap(data, data + 1) == 0);
+        assert(suffix_tree.longest_overlap(string("\xff\x07", 2)) == 1);
+        assert(suffix_tree.longest_overlap(string("\0\xff\0", 3)) == 2);
+    }
+    {
+        
+        const char* seq = "";
+        
+        SuffixTree suffix_tree(seq, seq);
+        
+        assert(suffix_tree.longest_overlap("A") == 0);
+        assert(suffix_tree.substring_locations("A").empty());
+    }
+    
+    {
+        
+        string seq = "AGTGCGATAGATGATAGAAGATCGCTCGCTCCGCGATA";
+        
+        SuffixTree suffix_tree(seq.begin(), seq.end());
+        
+        SuffixTreeMemoryUsage usage = suffix_tree.memory_usage();
+        
+        assert(usage.nodes > 0);
+        assert(usage.edges > 0);
+        assert(usage.construction_suffix_links > 0);
+        assert(usage.total() == usage.nodes + usage.edges);
+        
+#ifdef STRUCTURES_SUFFIX_TREE_STATS
+        assert(suffix_tree.stats().node_splits > 0);
+        assert(suffix_tree.stats().suffix_link_hops > 0);
+        assert(suffix_tree.stats().child_lookups > 0);
+#endif
+        
+        suffix_tree.reset_stats();
+        
+        vector<size_t> locs = suffix_tree.substring_locations("GATA");
+        
+#ifdef STRUCTURES_SUFFIX_TREE_STATS
+        assert(suffix_tree.stats().node_splits == 0);
+        assert(suffix_tree.stats().child_lookups > 0);
+        assert(suffix_tree.stats().dfs_nodes_visited >= locs.size());
+#else
+        assert(suffix_tree.stats().child_lookups == 0);
+        assert(suffix_tree.stats().dfs_nodes_visited == 0);
+#endif
+    }
     
     cerr << "All curated SuffixTree tests successful!" << endl;
 }
@@ -358,6 +484,26 @@ void test_suffix_tree_with_randomized_examples() {
                 }
                 
                 assert(st_locations == direct_locations);
+                
+                // a random window, which can extend past the end of the string
+                uniform_int_distribution<size_t> window_distr(0, str.size() + 1);
+                size_t window_begin = window_distr(gen);
+                size_t window_end = window_distr(gen);
+                vector<size_t> windowed_locations;
+                for (size_t location : direct_locations) {
+                    if (location >= window_begin && location < window_end) {
+                        windowed_locations.push_back(location);
+                    }
+                }
+                
+                if (suffix_tree.sorted_substring_locations(substr) != direct_locations
+                    || suffix_tree.sorted_substring_locations(substr, window_begin, window_end) != windowed_locations) {
+                    // print out the failures since their random and we might have a hard time finding them again
+                    cerr << "FAILURE: wrong sorted substring locations in [" << window_begin << ", " << window_end << ") on " << str << " " << substr << endl;
+                }
+                
+                assert(suffix_tree.sorted_substring_locations(substr) == direct_locations);
+                assert(suffix_tree.sorted_substring_locations(substr, window_begin, window_end) == windowed_locations);
             }
         }
         {
@@ -405,14 +551,306 @@ void test_suffix_tree_with_randomized_examples() {
                     }
                     
                     assert(st_locations == direct_locations);
+                    
+                    // a random window, which can extend past the end of the string
+                    uniform_int_distribution<size_t> window_distr(0, str.size() + 1);
+                    size_t window_begin = window_distr(gen);
+                    size_t window_end = window_distr(gen);
+                    vector<size_t> windowed_locations;
+                    for (size_t location : direct_locations) {
+                        if (location >= window_begin && location < window_end) {
+                            windowed_locations.push_back(location);
+                        }
+                    }
+                    
+                    if (suffix_tree.sorted_substring_locations(substr) != direct_locations
+                        || suffix_tree.sorted_substring_locations(substr, window_begin, window_end) != windowed_locations) {
+                        // print out the failures since their random and we might have a hard time finding them again
+                        cerr << "FAILURE: wrong sorted substring locations in [" << window_begin << ", " << window_end << ") on " << str << " " << substr << endl;
+                    }
+                    
+                    assert(suffix_tree.sorted_substring_locations(substr) == direct_locations);
+                    assert(suffix_tree.sorted_substring_locations(substr, window_begin, window_end) == windowed_locations);
+                }
+            }
+        }
+    }
+    
+    {
+        int num_suffix_trees = 100;
+        int num_substrings_per_tree = 10;
+        int max_str_len = 200;
+        int max_substring_length = 10;
+        double mismatch_rate = .03;
+        
+        // binary alphabet with nulls and bytes that are negative as chars
+        string alphabet("\0\x01\x80\xff", 4);
+        
+        random_device rd;
+        default_random_engine gen(rd());
+        uniform_int_distribution<int> str_len_distr(0, max_str_len);
+        uniform_int_distribution<int> substr_len_distr(0, max_substring_length);
+        
+        for (int i = 0; i < num_suffix_trees; i++) {
+            
+            string str = random_string(alphabet, str_len_distr(gen));
+            vector<uint8_t> bytes(str.begin(), str.end());
+            
+            SuffixTree suffix_tree(bytes.data(), bytes.data() + bytes.size());
+            
+            for (int j = 0; j < num_substrings_per_tree; j++) {
+                
+                string substr = random_substring(str, substr_len_distr(gen), alphabet, mismatch_rate);
+                
+                vector<size_t> st_locations = suffix_tree.substring_locations(substr);
+                sort(st_locations.begin(), st_locations.end());
+                vector<size_t> direct_locations = substring_locations(str, substr);
+                
+                size_t suffix_tree_longest_overlap = suffix_tree.longest_overlap(substr);
+                size_t brute_longest_overlap = longest_overlap(str, substr);
+                
+                if (st_locations != direct_locations || suffix_tree_longest_overlap != brute_longest_overlap) {
+                    // print out the failures since their random and we might have a hard time finding them again
+                    cerr << "FAILURE: wrong result on binary string of length " << str.size() << " and query of length " << substr.size() << endl;
+                }
+                
+                assert(st_locations == direct_locations);
+                assert(suffix_tree_longest_overlap == brute_longest_overlap);
+            }
+            
+            uniform_int_distribution<size_t> pos_distr(0, str.size());
+            for (int j = 0; j < num_substrings_per_tree; j++) {
+                size_t pos1 = pos_distr(gen);
+                size_t pos2 = pos_distr(gen);
+                
+                size_t lce = 0;
+                while (pos1 + lce < str.size() && pos2 + lce < str.size() && str[pos1 + lce] == str[pos2 + lce]) {
+                    lce++;
+                }
+                
+                if (suffix_tree.longest_common_extension(pos1, pos2) != lce) {
+                    // print out the failures since their random and we might have a hard time finding them again
+                    cerr << "FAILURE: wrong LCE at " << pos1 << " and " << pos2 << " on binary string of length " << str.size() << endl;
+                }
+                
+                assert(suffix_tree.longest_common_extension(pos1, pos2) == lce);
+            }
+        }
+    }
+    {
+        int num_suffix_trees = 20;
+        int num_queries_per_tree = 200;
+        int max_str_len = 5000;
+        
+        // long enough that the extension index has many blocks of leaves
+        string alphabet = "AC";
+        
+        random_device rd;
+        default_random_engine gen(rd());
+        uniform_int_distribution<int> str_len_distr(0, max_str_len);
+        
+        for (int i = 0; i < num_suffix_trees; i++) {
+            
+            string str = random_string(alphabet, str_len_distr(gen));
+            
+            SuffixTree suffix_tree(str.begin(), str.end());
+            
+            uniform_int_distribution<size_t> pos_distr(0, str.size());
+            for (int j = 0; j < num_queries_per_tree; j++) {
+                size_t pos1 = pos_distr(gen);
+                size_t pos2 = pos_distr(gen);
+                
+                size_t lce = 0;
+                while (pos1 + lce < str.size() && pos2 + lce < str.size() && str[pos1 + lce] == str[pos2 + lce]) {
+                    lce++;
+                }
+                
+                if (suffix_tree.longest_common_extension(pos1, pos2) != lce) {
+                    // print out the failures since their random and we might have a hard time finding them again
+                    cerr << "FAILURE: wrong LCE at " << pos1 << " and " << pos2 << " on string of length " << str.size() << endl;
                 }
+                
+                assert(suffix_tree.longest_common_extension(pos1, pos2) == lce);
             }
+            
+            // the index takes a few words per character rather than a sparse table's log n
+            assert(suffix_tree.memory_usage().lce_index <= 4 * sizeof(size_t) * (str.size() + 1) + 64);
         }
     }
     
     cerr << "All randomized SuffixTree tests successful!" << endl;
 }
 
+void test_sliding_suffix_tree_with_curated_examples() {
+    {
+        
+        SlidingSuffixTree suffix_tree(5);
+        
+        string stream = "ACGTGACA";
+        for (char c : stream) {
+            suffix_tree.append(c);
+        }
+        
+        assert(suffix_tree.size() == 5);
+        assert(suffix_tree.front_position() == 3);
+        assert(suffix_tree.end_position() == 8);
+        assert(suffix_tree.at(3) == 'T');
+        
+        assert(suffix_tree.longest_overlap("ACAGCCT") == 3);
+        assert(suffix_tree.longest_overlap("TGACA") == 5);
+        assert(suffix_tree.longest_overlap("CGTGACA") == 0);
+        
+        vector<size_t> locs = suffix_tree.substring_locations("A");
+        sort(locs.begin(), locs.end());
+        
+        vector<size_t> correct_locs {5, 7};
+        
+        assert(locs == correct_locs);
+        
+        // this occurrence has already left the window
+        assert(suffix_tree.substring_locations("CG").empty());
+    }
+    {
+        
+        SlidingSuffixTree suffix_tree(4);
+        
+        string stream = "AAAAAAA";
+        for (char c : stream) {
+            suffix_tree.append(c);
+        }
+        
+        vector<size_t> locs = suffix_tree.substring_locations("AA");
+        sort(locs.begin(), locs.end());
+        
+        vector<size_t> correct_locs {3, 4, 5};
+        
+        assert(locs == correct_locs);
+        assert(suffix_tree.longest_overlap("AAAAAAA") == 4);
+        
+        suffix_tree.expire_front();
+        suffix_tree.expire_front();
+        
+        locs = suffix_tree.substring_locations("AA");
+        
+        correct_locs = {5};
+        
+        assert(locs == correct_locs);
+        assert(suffix_tree.longest_overlap("AAAAAAA") == 2);
+        
+        suffix_tree.expire_front();
+        suffix_tree.expire_front();
+        
+        assert(suffix_tree.size() == 0);
+        assert(suffix_tree.substring_locations("A").empty());
+        assert(suffix_tree.longest_overlap("A") == 0);
+    }
+    {
+        
+        SlidingSuffixTree suffix_tree(10);
+        
+        string stream("AC\0GT\0", 6);
+        for (char c : stream) {
+            suffix_tree.append(c);
+        }
+        
+        vector<size_t> locs = suffix_tree.substring_locations(string(1, '\0'));
+        sort(locs.begin(), locs.end());
+        
+        vector<size_t> correct_locs {2, 5};
+        
+        assert(locs == correct_locs);
+        assert(suffix_tree.longest_overlap(string("T\0A", 3)) == 2);
+    }
+    
+    cerr << "All curated SlidingSuffixTree tests successful!" << endl;
+}
+
+void test_sliding_suffix_tree_with_randomized_examples() {
+    
+    int num_streams = 200;
+    int stream_length = 1000;
+    int max_window_size = 50;
+    int num_queries_per_step = 2;
+    int max_query_length = 8;
+    double expire_rate = .2;
+    
+    vector<string> alphabets {"A", "AC", "ACGTN"};
+    
+    random_device rd;
+    default_random_engine gen(rd());
+    uniform_int_distribution<int> window_distr(1, max_window_size);
+    uniform_int_distribution<int> query_len_distr(0, max_query_length);
+    uniform_real_distribution<double> expire_distr(0.0, 1.0);
+    
+    for (int i = 0; i < num_streams; i++) {
+        
+        string& alphabet = alphabets[i % alphabets.size()];
+        uniform_int_distribution<int> char_distr(0, alphabet.size() - 1);
+        
+        size_t window_size = window_distr(gen);
+        SlidingSuffixTree suffix_tree(window_size);
+        
+        // the stream position of the first character in the window
+        size_t window_begin = 0;
+        string window;
+        
+        for (int j = 0; j < stream_length; j++) {
+            
+            if (!window.empty() && expire_distr(gen) < expire_rate) {
+                suffix_tree.expire_front();
+                window.erase(window.begin());
+                window_begin++;
+            }
+            else {
+                char c = alphabet[char_distr(gen)];
+                suffix_tree.append(c);
+                window.push_back(c);
+                if (window.size() > window_size) {
+                    window.erase(window.begin());
+                    window_begin++;
+                }
+            }
+            
+            assert(suffix_tree.size() == window.size());
+            assert(suffix_tree.front_position() == window_begin);
+            
+            for (int k = 0; k < num_queries_per_step; k++) {
+                
+                string query = random_string(alphabet, query_len_distr(gen));
+                
+                vector<size_t> st_locations = suffix_tree.substring_locations(query);
+                sort(st_locations.begin(), st_locations.end());
+                vector<size_t> direct_locations;
+                if (query.size() <= window.size()) {
+                    direct_locations = substring_locations(window, query);
+                }
+                for (size_t& location : direct_locations) {
+                    location += window_begin;
+                }
+                
+                if (st_locations != direct_locations) {
+                    // print out the failures since their random and we might have a hard time finding them again
+                    cerr << "FAILURE: wrong substring locations on " << window << " " << query << endl;
+                }
+                
+                assert(st_locations == direct_locations);
+                
+                size_t st_longest_overlap = suffix_tree.longest_overlap(query);
+                size_t brute_longest_overlap = longest_overlap(window, query);
+                
+                if (st_longest_overlap != brute_longest_overlap) {
+                    // print out the failures since their random and we might have a hard time finding them again
+                    cerr << "FAILURE: wrong overlap of " << st_longest_overlap << " on " << window << " " << query << endl;
+                }
+                
+                assert(st_longest_overlap == brute_longest_overlap);
+            }
+        }
+    }
+    
+    cerr << "All randomized SlidingSuffixTree tests successful!" << endl;
+}
+
 vector<pair<size_t, size_t>> random_unions(size_t size) {
     
     int num_pairs = size * size;
@@ -594,156 +1032,1530 @@ void test_union_find_with_curated_examples() {
         assert(std::equal(group_of_4_1.begin(), group_of_4_1.end(), group_of_4_2_from_all.begin()));
         assert(std::equal(group_of_4_1.begin(), group_of_4_1.end(), group_of_4_2.begin()));
         
-        assert(std::equal(group_of_9_1.begin(), group_of_9_1.end(), group_of_9_1_from_all.begin()));
-        assert(std::equal(group_of_9_1.begin(), group_of_9_1.end(), group_of_9_2_from_all.begin()));
-        assert(std::equal(group_of_9_1.begin(), group_of_9_1.end(), group_of_9_2.begin()));
+        assert(std::equal(group_of_9_1.begin(), group_of_9_1.end(), group_of_9_1_from_all.begin()));
+        assert(std::equal(group_of_9_1.begin(), group_of_9_1.end(), group_of_9_2_from_all.begin()));
+        assert(std::equal(group_of_9_1.begin(), group_of_9_1.end(), group_of_9_2.begin()));
+    }
+    
+    {
+        UnionFind union_find_1(10);
+        UnionFind union_find_2(10);
+        
+        union_find_1.union_groups(0, 1);
+        union_find_1.union_groups(2, 1);
+        union_find_1.union_groups(3, 2);
+        union_find_1.union_groups(4, 5);
+        union_find_1.union_groups(7, 6);
+        union_find_1.union_groups(7, 8);
+        union_find_1.union_groups(7, 9);
+        
+        union_find_2.union_groups(0, 1);
+        union_find_2.union_groups(2, 1);
+        union_find_2.union_groups(3, 2);
+        union_find_2.union_groups(4, 5);
+        union_find_2.union_groups(7, 6);
+        union_find_2.union_groups(7, 8);
+        union_find_2.union_groups(7, 9);
+        
+        assert(union_find_1.group_size(0) == union_find_2.group(0).size());
+        assert(union_find_2.group_size(0) == union_find_1.group(0).size());
+        assert(union_find_1.group_size(0) == union_find_1.group(0).size());
+        assert(union_find_2.group_size(0) == union_find_2.group(0).size());
+        
+        assert(union_find_1.group_size(3) == union_find_2.group(3).size());
+        assert(union_find_2.group_size(3) == union_find_1.group(3).size());
+        assert(union_find_1.group_size(3) == union_find_1.group(3).size());
+        assert(union_find_2.group_size(3) == union_find_2.group(3).size());
+        
+        assert(union_find_1.group_size(9) == union_find_2.group(9).size());
+        assert(union_find_2.group_size(9) == union_find_1.group(9).size());
+        assert(union_find_1.group_size(9) == union_find_1.group(9).size());
+        assert(union_find_2.group_size(9) == union_find_2.group(9).size());
+    }
+    {
+        UnionFind union_find;
+        union_find.reserve(4);
+        
+        assert(union_find.size() == 0);
+        assert(union_find.add_element() == 0);
+        assert(union_find.add_element() == 1);
+        assert(union_find.add_element() == 2);
+        
+        union_find.union_groups(0, 2);
+        size_t group_id = union_find.find_group(0);
+        
+        // growing past the reserved size should not disturb the existing groups
+        for (size_t i = 3; i < 100; i++) {
+            assert(union_find.add_element() == i);
+            assert(union_find.find_group(i) == i);
+            assert(union_find.group_size(i) == 1);
+        }
+        
+        assert(union_find.size() == 100);
+        assert(union_find.find_group(2) == group_id);
+        assert(union_find.group_size(0) == 2);
+        assert(union_find.group_size(1) == 1);
+        
+        union_find.union_groups(99, 1);
+        union_find.union_groups(2, 50);
+        
+        vector<size_t> group = union_find.group(50);
+        sort(group.begin(), group.end());
+        vector<size_t> correct_group {0, 2, 50};
+        assert(group == correct_group);
+        assert(union_find.group_size(1) == 2);
+    }
+    {
+        UnionFind union_find(8);
+        assert(union_find.num_groups() == 8);
+        assert(union_find.group_size_histogram() == vector<size_t>{8});
+        
+        // changes before the first checkpoint are not recorded
+        union_find.union_groups(0, 1);
+        size_t epoch_1 = union_find.checkpoint();
+        assert(union_find.changed_groups_since(epoch_1).empty());
+        
+        union_find.union_groups(2, 3);
+        union_find.union_groups(4, 5);
+        union_find.union_groups(3, 2);
+        size_t epoch_2 = union_find.checkpoint();
+        
+        union_find.union_groups(5, 6);
+        size_t i = union_find.add_element();
+        
+        vector<size_t> changed = union_find.changed_groups_since(epoch_1);
+        vector<size_t> correct_changed {union_find.find_group(2), union_find.find_group(4), i};
+        sort(correct_changed.begin(), correct_changed.end());
+        assert(changed == correct_changed);
+        
+        changed = union_find.changed_groups_since(epoch_2);
+        correct_changed = {union_find.find_group(4), i};
+        sort(correct_changed.begin(), correct_changed.end());
+        assert(changed == correct_changed);
+        
+        // a group that changes twice is only listed once, by its current ID
+        union_find.discard_changes_before(epoch_2);
+        union_find.union_groups(6, 3);
+        changed = union_find.changed_groups_since(epoch_2);
+        correct_changed = {union_find.find_group(2), i};
+        sort(correct_changed.begin(), correct_changed.end());
+        assert(changed == correct_changed);
+        
+        assert(union_find.changed_groups_since(union_find.checkpoint()).empty());
+        
+        // groups of sizes 1, 1, 2, 5
+        assert(union_find.num_groups() == 4);
+        vector<size_t> correct_histogram {2, 1, 1};
+        assert(union_find.group_size_histogram() == correct_histogram);
+    }
+    {
+        // a binomial tree that is only ever linked at its heads, so that nothing is compressed
+        // until we find from the deepest index
+        BasicUnionFind<size_t, PathSplitting, true> union_find(16);
+        BasicUnionFind<size_t, PathSplitting> uncounted_union_find(16);
+        for (size_t step = 1; step < 16; step *= 2) {
+            for (size_t i = 0; i + step < 16; i += 2 * step) {
+                union_find.union_groups(i + step - 1, i + 2 * step - 1);
+                uncounted_union_find.union_groups(i + step - 1, i + 2 * step - 1);
+            }
+        }
+        
+        // a single head of rank 4
+        assert(union_find.rank_distribution() == vector<size_t>({0, 0, 0, 0, 1}));
+        assert(uncounted_union_find.rank_distribution() == vector<size_t>({0, 0, 0, 0, 1}));
+        
+        assert(union_find.stats().unions == 15);
+        assert(union_find.stats().merges == 15);
+        assert(union_find.stats().finds == 30);
+        assert(union_find.stats().path_lengths[0] == 30);
+        assert(union_find.stats().reparented == 0);
+        
+        union_find.reset_stats();
+        assert(union_find.stats().finds == 0);
+        
+        // the path 0, 1, 3, 7, 15 is split into 0, 3, 15 and 1, 7, 15
+        assert(union_find.find_group(0) == 15);
+        union_find.union_groups(0, 15);
+        
+        assert(union_find.stats().finds == 3);
+        assert(union_find.stats().unions == 1);
+        assert(union_find.stats().merges == 0);
+        assert(union_find.stats().path_lengths[4] == 1);
+        assert(union_find.stats().path_lengths[2] == 1);
+        assert(union_find.stats().path_lengths[0] == 1);
+        assert(union_find.stats().reparented == 4);
+        
+        // without counting, the same work leaves the counters at zero
+        assert(uncounted_union_find.find_group(0) == 15);
+        uncounted_union_find.union_groups(0, 15);
+        assert(uncounted_union_find.stats().finds == 0);
+        assert(uncounted_union_find.stats().unions == 0);
+        assert(uncounted_union_find.stats().reparented == 0);
+    }
+    {
+        // the same binomial tree, in which full compression points 0, 1, and 3 at the head
+        // and path halving only points 0 and 3 at their grandparents
+        BasicUnionFind<uint32_t, FullCompression, true> full(16);
+        BasicUnionFind<uint32_t, PathHalving, true> halving(16);
+        for (size_t step = 1; step < 16; step *= 2) {
+            for (size_t i = 0; i + step < 16; i += 2 * step) {
+                full.union_groups(i + step - 1, i + 2 * step - 1);
+                halving.union_groups(i + step - 1, i + 2 * step - 1);
+            }
+        }
+        full.reset_stats();
+        halving.reset_stats();
+        
+        assert(full.find_group(0) == 15);
+        assert(full.stats().finds == 1);
+        assert(full.stats().path_lengths[4] == 1);
+        assert(full.stats().reparented == 3);
+        
+        assert(halving.find_group(0) == 15);
+        assert(halving.stats().finds == 1);
+        assert(halving.stats().path_lengths[4] == 1);
+        assert(halving.stats().reparented == 2);
+    }
+    {
+        // two shards of the indices 0, ..., 9, which overlap at 4 and 5
+        UnionFind shard_1(6);
+        shard_1.union_groups(0, 1);
+        shard_1.union_groups(1, 4);
+        shard_1.union_groups(2, 3);
+        
+        UnionFind shard_2(6);
+        shard_2.union_groups(0, 3);
+        shard_2.union_groups(1, 2);
+        shard_2.union_groups(4, 5);
+        vector<size_t> shard_2_indices {4, 5, 6, 7, 8, 9};
+        
+        vector<size_t> forest = shard_1.parent_forest();
+        for (size_t i = 0; i < forest.size(); i++) {
+            assert(forest[i] == shard_1.find_group(i));
+        }
+        
+        UnionFind union_find(10);
+        union_find.merge_from_forest(forest);
+        union_find.merge_from(shard_2, shard_2_indices);
+        
+        vector<vector<size_t>> groups = union_find.all_groups();
+        sort(groups.begin(), groups.end());
+        vector<vector<size_t>> correct_groups {{0, 1, 4, 7}, {2, 3}, {5, 6}, {8, 9}};
+        assert(groups == correct_groups);
+        
+        // merging a UnionFind into a copy of itself changes nothing
+        UnionFind copy = union_find;
+        copy.merge_from(union_find);
+        groups = copy.all_groups();
+        sort(groups.begin(), groups.end());
+        assert(groups == correct_groups);
+    }
+    {
+        char path[] = "/tmp/union_find_XXXXXX";
+        int fd = mkstemp(path);
+        assert(fd >= 0);
+        close(fd);
+        
+        UnionFind union_find(10);
+        union_find.union_groups(0, 5);
+        union_find.union_groups(5, 9);
+        union_find.union_groups(2, 3);
+        assert(union_find.save(path));
+        
+        UnionFind loaded;
+        assert(loaded.load(path));
+        assert(loaded.size() == 10);
+        assert(loaded.num_groups() == 7);
+        assert(loaded.group_size_histogram() == union_find.group_size_histogram());
+        assert(loaded.all_groups() == union_find.all_groups());
+        assert(loaded.group_size(9) == 3);
+        
+        // the loaded groups can still be changed and grown
+        loaded.union_groups(3, 9);
+        size_t i = loaded.add_element();
+        loaded.union_groups(i, 0);
+        assert(loaded.group_size(2) == 6);
+        assert(loaded.num_groups() == 6);
+        
+        // copies do not share the mapping
+        UnionFind copy;
+        assert(copy.load(path));
+        UnionFind copy_of_copy = copy;
+        copy.union_groups(1, 4);
+        assert(copy_of_copy.group_size(1) == 1);
+        
+        // the changes are not written back to the file
+        UnionFind reloaded;
+        assert(reloaded.load(path));
+        assert(reloaded.all_groups() == union_find.all_groups());
+        
+        // saving over the file that is mapped replaces it without disturbing the mapping
+        UnionFind resaved;
+        assert(resaved.load(path));
+        resaved.union_groups(1, 2);
+        assert(resaved.save(path));
+        assert(resaved.group_size(1) == 3);
+        assert(resaved.find_group(3) == resaved.find_group(1));
+        UnionFind loaded_again;
+        assert(loaded_again.load(path));
+        assert(loaded_again.all_groups() == resaved.all_groups());
+        assert(loaded_again.num_groups() == 6);
+        assert(reloaded.group_size(1) == 1);
+        
+        // a parent or member that points outside of the indices is rejected
+        for (size_t offset : {sizeof(size_t), 2 * 10 * sizeof(size_t)}) {
+            char corrupt_path[] = "/tmp/union_find_XXXXXX";
+            fd = mkstemp(corrupt_path);
+            assert(fd >= 0);
+            close(fd);
+            assert(union_find.save(corrupt_path));
+            FILE* corrupt_file = fopen(corrupt_path, "r+b");
+            assert(corrupt_file);
+            // the arrays begin after the header, which is the rest of the file
+            fseek(corrupt_file, -long(10 * (3 * sizeof(size_t) + 1)) + long(offset), SEEK_END);
+            size_t out_of_bounds = 10;
+            fwrite(&out_of_bounds, sizeof(size_t), 1, corrupt_file);
+            fclose(corrupt_file);
+            assert(!loaded_again.load(corrupt_path));
+            assert(loaded_again.all_groups() == resaved.all_groups());
+            remove(corrupt_path);
+        }
+        
+        // an empty file is not a UnionFind, and a failed load leaves the groups alone
+        char empty_path[] = "/tmp/union_find_XXXXXX";
+        fd = mkstemp(empty_path);
+        assert(fd >= 0);
+        close(fd);
+        assert(!reloaded.load(empty_path));
+        assert(reloaded.all_groups() == union_find.all_groups());
+        
+        remove(empty_path);
+        assert(!reloaded.load(empty_path));
+        remove(path);
+    }
+    
+    cerr << "All curated UnionFind tests successful!" << endl;
+}
+
+void test_union_find_with_random_examples() {
+    for (size_t repetition = 0; repetition < 1000; repetition++) {
+        
+        UnionFind union_find(30);
+        
+        vector<pair<size_t, size_t>> unions = random_unions(union_find.size());
+        
+        vector<unordered_set<size_t>*> group_set_of(union_find.size());
+        vector<unordered_set<size_t>> group_sets(union_find.size());
+        for (size_t i = 0; i < union_find.size(); i++) {
+            group_set_of[i] = &group_sets[i];
+            group_sets[i].insert(i);
+        }
+        
+        for (pair<size_t, size_t> idxs : unions) {
+            union_find.union_groups(idxs.first, idxs.second);
+            
+            auto group_set_1 = group_set_of[idxs.first];
+            auto group_set_2 = group_set_of[idxs.second];
+            if (group_set_1 == group_set_2) {
+                continue;
+            }
+            for (size_t i : *group_set_2) {
+                group_set_1->insert(i);
+                group_set_of[i] = group_set_1;
+            }
+            group_set_2->clear();
+        }
+        
+        vector<vector<size_t>> groups_direct(union_find.size());
+        vector<vector<size_t>> groups_from_all(union_find.size());
+        vector<vector<size_t>> groups_orthogonal(union_find.size());
+        // alternate the order these operations are done in just in case the
+        // internal changes during find functions affects the outcome
+        if (repetition % 2 == 0) {
+            for (size_t i = 0; i < union_find.size(); i++) {
+                groups_direct[i] = union_find.group(i);
+            }
+            
+            vector<vector<size_t>> groups = union_find.all_groups();
+            for (vector<size_t>& group : groups) {
+                for (size_t i : group) {
+                    groups_from_all[i] = group;
+                }
+            }
+        }
+        else {
+            vector<vector<size_t>> groups = union_find.all_groups();
+            for (vector<size_t>& group : groups) {
+                for (size_t i : group) {
+                    groups_from_all[i] = group;
+                }
+            }
+            
+            for (size_t i = 0; i < union_find.size(); i++) {
+                groups_direct[i] = union_find.group(i);
+            }
+        }
+        
+        for (size_t i = 0; i < union_find.size(); i++) {
+            vector<size_t>& group = groups_orthogonal[i];
+            for (size_t j : *group_set_of[i]) {
+                group.push_back(j);
+            }
+        }
+        
+        for (size_t i = 0; i < union_find.size(); i++) {
+            
+            std::sort(groups_orthogonal[i].begin(), groups_orthogonal[i].end());
+            std::sort(groups_from_all[i].begin(), groups_from_all[i].end());
+            std::sort(groups_direct[i].begin(), groups_direct[i].end());
+            
+            
+            assert(union_find.group_size(i) == groups_from_all[i].size());
+            assert(union_find.group_size(i) == groups_direct[i].size());
+            assert(groups_from_all[i].size() == groups_direct[i].size());
+            assert(groups_orthogonal[i].size() == groups_direct[i].size());
+            
+            if (!std::equal(groups_from_all[i].begin(), groups_from_all[i].end(),
+                            groups_direct[i].begin())) {
+                cerr << "FAILURE mismatch in repetition " << repetition << " in the following groups containing " << i << endl;
+                cerr << "computed directly: ";
+                for (size_t j : groups_direct[i]) {
+                    cerr << j << " ";
+                }
+                cerr << endl;
+                cerr << "computed in batch: ";
+                for (size_t j : groups_from_all[i]) {
+                    cerr << j << " ";
+                }
+                cerr << endl;
+                cerr << "groups formed by unions: ";
+                for (pair<size_t, size_t> idxs : unions) {
+                    cerr << "(" << idxs.first << "," << idxs.second << ") ";
+                }
+                cerr << endl;
+            }
+            
+            assert(std::equal(groups_from_all[i].begin(), groups_from_all[i].end(),
+                               groups_direct[i].begin()));
+            assert(std::equal(groups_from_all[i].begin(), groups_from_all[i].end(),
+                               groups_orthogonal[i].begin()));
+        }
+        
+        // visiting the members should give the same groups, starting from the index itself
+        for (size_t i = 0; i < union_find.size(); i++) {
+            vector<size_t> members;
+            union_find.for_each_member(i, [&](size_t member) {
+                members.push_back(member);
+            });
+            assert(members.front() == i);
+            sort(members.begin(), members.end());
+            assert(members == groups_direct[i]);
+        }
+        
+        // the flat format should have the same groups in the same order, in serial and in parallel
+        vector<vector<size_t>> all_groups = union_find.all_groups();
+        for (size_t num_threads : {1, 3}) {
+            UnionFindGroups groups = union_find.all_groups_csr(num_threads);
+            
+            assert(groups.num_groups() == all_groups.size());
+            assert(groups.offsets.front() == 0);
+            assert(groups.offsets.back() == union_find.size());
+            for (size_t k = 0; k < groups.num_groups(); k++) {
+                vector<size_t> group(groups.members.begin() + groups.offsets[k],
+                                     groups.members.begin() + groups.offsets[k + 1]);
+                if (group != all_groups[k]) {
+                    // print out the failures since their random and we might have a hard time finding them again
+                    cerr << "FAILURE: wrong CSR group " << k << " with " << num_threads << " threads in repetition " << repetition << endl;
+                }
+                assert(group == all_groups[k]);
+            }
+        }
+        
+        // the online counts should match a count of the groups
+        vector<size_t> correct_histogram;
+        for (const vector<size_t>& group : all_groups) {
+            size_t bucket = 0;
+            while ((size_t(2) << bucket) <= group.size()) {
+                bucket++;
+            }
+            if (correct_histogram.size() <= bucket) {
+                correct_histogram.resize(bucket + 1, 0);
+            }
+            correct_histogram[bucket]++;
+        }
+        if (union_find.num_groups() != all_groups.size() || union_find.group_size_histogram() != correct_histogram) {
+            // print out the failures since their random and we might have a hard time finding them again
+            cerr << "FAILURE: wrong group counts in repetition " << repetition << endl;
+        }
+        assert(union_find.num_groups() == all_groups.size());
+        assert(union_find.group_size_histogram() == correct_histogram);
+        
+        // the changed groups should be exactly the ones that are not the same as any group
+        // at the checkpoint
+        UnionFind tracked_union_find(union_find.size());
+        size_t num_before = unions.size() / 2;
+        for (size_t k = 0; k < num_before; k++) {
+            tracked_union_find.union_groups(unions[k].first, unions[k].second);
+        }
+        size_t epoch = tracked_union_find.checkpoint();
+        vector<vector<size_t>> groups_before = tracked_union_find.all_groups();
+        sort(groups_before.begin(), groups_before.end());
+        for (size_t k = num_before; k < unions.size(); k++) {
+            tracked_union_find.union_groups(unions[k].first, unions[k].second);
+        }
+        vector<size_t> correct_changed;
+        for (const vector<size_t>& group : tracked_union_find.all_groups()) {
+            if (!binary_search(groups_before.begin(), groups_before.end(), group)) {
+                correct_changed.push_back(tracked_union_find.find_group(group.front()));
+            }
+        }
+        sort(correct_changed.begin(), correct_changed.end());
+        if (tracked_union_find.changed_groups_since(epoch) != correct_changed) {
+            // print out the failures since their random and we might have a hard time finding them again
+            cerr << "FAILURE: wrong changed groups in repetition " << repetition << endl;
+        }
+        assert(tracked_union_find.changed_groups_since(epoch) == correct_changed);
+        
+        // splitting the unions between shards and merging them should give the same groups
+        UnionFind shard_1(union_find.size());
+        UnionFind shard_2(union_find.size());
+        for (size_t k = 0; k < unions.size(); k++) {
+            UnionFind& shard = (k % 2 == 0) ? shard_1 : shard_2;
+            shard.union_groups(unions[k].first, unions[k].second);
+        }
+        shard_1.merge_from_forest(shard_2.parent_forest());
+        vector<vector<size_t>> merged_groups = shard_1.all_groups();
+        vector<vector<size_t>> sorted_groups = all_groups;
+        sort(merged_groups.begin(), merged_groups.end());
+        sort(sorted_groups.begin(), sorted_groups.end());
+        if (merged_groups != sorted_groups) {
+            // print out the failures since their random and we might have a hard time finding them again
+            cerr << "FAILURE: wrong merged groups in repetition " << repetition << endl;
+        }
+        assert(merged_groups == sorted_groups);
+    }
+    
+    for (size_t repetition = 0; repetition < 10; repetition++) {
+        
+        // large enough that the parallel flat format sorts on more than one digit of the heads,
+        // with one large group and many small ones
+        UnionFind union_find(100000);
+        random_device rd;
+        default_random_engine gen(rd());
+        uniform_int_distribution<size_t> index_distr(0, union_find.size() - 1);
+        for (size_t k = 0; k < union_find.size() / 2; k++) {
+            union_find.union_groups(index_distr(gen), index_distr(gen) % 1000);
+        }
+        for (size_t k = 0; k < union_find.size() / 4; k++) {
+            union_find.union_groups(index_distr(gen), index_distr(gen));
+        }
+        
+        UnionFindGroups serial_groups = union_find.all_groups_csr(1);
+        for (size_t num_threads : {2, 4}) {
+            UnionFindGroups groups = union_find.all_groups_csr(num_threads);
+            if (groups.offsets != serial_groups.offsets || groups.members != serial_groups.members) {
+                // print out the failures since their random and we might have a hard time finding them again
+                cerr << "FAILURE: wrong large CSR groups with " << num_threads << " threads in repetition " << repetition << endl;
+            }
+            assert(groups.offsets == serial_groups.offsets);
+            assert(groups.members == serial_groups.members);
+        }
+    }
+    
+    cerr << "All randomized UnionFind tests successful!" << endl;
+}
+
+template <typename Index, typename FindPolicy>
+void check_basic_union_find(const vector<pair<size_t, size_t>>& unions, size_t size, size_t repetition) {
+    UnionFind union_find(size);
+    BasicUnionFind<Index, FindPolicy> basic_union_find(size);
+    for (pair<size_t, size_t> idxs : unions) {
+        union_find.union_groups(idxs.first, idxs.second);
+        basic_union_find.union_groups(idxs.first, idxs.second);
+    }
+    vector<vector<size_t>> groups = union_find.all_groups();
+    vector<vector<size_t>> basic_groups = basic_union_find.all_groups();
+    sort(groups.begin(), groups.end());
+    sort(basic_groups.begin(), basic_groups.end());
+    if (groups != basic_groups) {
+        // print out the failures since their random and we might have a hard time finding them again
+        cerr << "FAILURE: BasicUnionFind with " << sizeof(Index) << " byte indices has wrong groups in repetition " << repetition << endl;
+    }
+    assert(groups == basic_groups);
+    for (size_t i = 0; i < size; i++) {
+        assert(basic_union_find.group_size(i) == union_find.group_size(i));
+        assert(basic_union_find.find_group(i) == basic_union_find.find_group_const(i));
+    }
+    assert(basic_union_find.num_groups() == union_find.num_groups());
+    
+    // compacting keeps the groups, and relabeling also makes each group contiguous
+    BasicUnionFind<Index, FindPolicy> relabeled = basic_union_find;
+    assert(basic_union_find.compact().empty());
+    vector<vector<size_t>> compacted_groups = basic_union_find.all_groups();
+    sort(compacted_groups.begin(), compacted_groups.end());
+    assert(compacted_groups == basic_groups);
+    
+    vector<size_t> new_indices = relabeled.compact(true);
+    vector<size_t> sorted_indices = new_indices;
+    sort(sorted_indices.begin(), sorted_indices.end());
+    for (size_t i = 0; i < size; i++) {
+        assert(sorted_indices[i] == i);
+        size_t head = relabeled.find_group_const(new_indices[i]);
+        vector<size_t> members = relabeled.group(head);
+        if (members.size() != union_find.group_size(i)) {
+            cerr << "FAILURE: BasicUnionFind with " << sizeof(Index) << " byte indices has wrong relabeled group size in repetition " << repetition << endl;
+        }
+        assert(members.size() == union_find.group_size(i));
+        for (size_t k = 0; k < members.size(); k++) {
+            assert(members[k] == head + k);
+        }
+        for (size_t j = 0; j < size; j++) {
+            assert((union_find.find_group(i) == union_find.find_group(j))
+                   == (relabeled.find_group(new_indices[i]) == relabeled.find_group(new_indices[j])));
+        }
+    }
+    assert(relabeled.num_groups() == union_find.num_groups());
+    assert(relabeled.group_size_histogram() == union_find.group_size_histogram());
+}
+
+void test_basic_union_find() {
+    {
+        BasicUnionFind<uint32_t, PathHalving> union_find(6);
+        union_find.union_groups(0, 1);
+        union_find.union_groups(2, 3);
+        union_find.union_groups(1, 3);
+        assert(union_find.group_size(0) == 4);
+        assert(union_find.find_group(0) == union_find.find_group(2));
+        assert(union_find.add_element() == 6);
+        union_find.union_groups(6, 5);
+        assert(union_find.group_size(5) == 2);
+        
+        // saved files can only be loaded with the same index width
+        char path[] = "/tmp/union_find_XXXXXX";
+        int fd = mkstemp(path);
+        assert(fd >= 0);
+        close(fd);
+        assert(union_find.save(path));
+        
+        BasicUnionFind<uint32_t, PathSplitting> loaded;
+        assert(loaded.load(path));
+        assert(loaded.all_groups() == union_find.all_groups());
+        UnionFind wide;
+        assert(!wide.load(path));
+        remove(path);
+    }
+    {
+        UnionFind union_find(6);
+        union_find.union_groups(5, 1);
+        size_t epoch = union_find.checkpoint();
+        union_find.union_groups(4, 0);
+        union_find.union_groups(0, 2);
+        
+        vector<size_t> new_indices = union_find.compact(true);
+        assert(union_find.group_size(new_indices[2]) == 3);
+        assert(union_find.find_group(new_indices[5]) == union_find.find_group(new_indices[1]));
+        assert(union_find.find_group(new_indices[3]) == new_indices[3]);
+        
+        // the changes are reported under the new indices
+        assert(union_find.changed_groups_since(epoch) == vector<size_t>(1, union_find.find_group(new_indices[4])));
+        
+        // a copy of the groups answers the same queries without the record of changes
+        UnionFind copy = union_find.copy_groups();
+        assert(copy.size() == union_find.size());
+        assert(copy.num_groups() == union_find.num_groups());
+        assert(copy.group_size_histogram() == union_find.group_size_histogram());
+        assert(copy.rank_distribution() == union_find.rank_distribution());
+        for (size_t i = 0; i < copy.size(); i++) {
+            assert(copy.find_group_const(i) == union_find.find_group(i));
+            assert(copy.group(i) == union_find.group(i));
+        }
+        size_t copy_epoch = copy.checkpoint();
+        assert(copy_epoch == 0);
+        assert(copy.changed_groups_since(copy_epoch).empty());
+    }
+    {
+        for (size_t repetition = 0; repetition < 100; repetition++) {
+            size_t size = 30;
+            vector<pair<size_t, size_t>> unions = random_unions(size);
+            check_basic_union_find<uint32_t, FullCompression>(unions, size, repetition);
+            check_basic_union_find<uint32_t, PathHalving>(unions, size, repetition);
+            check_basic_union_find<uint32_t, PathSplitting>(unions, size, repetition);
+            check_basic_union_find<uint64_t, PathHalving>(unions, size, repetition);
+            check_basic_union_find<uint64_t, PathSplitting>(unions, size, repetition);
+        }
+    }
+    
+    cerr << "All BasicUnionFind tests successful!" << endl;
+}
+
+void test_keyed_union_find() {
+    {
+        KeyedUnionFind<string> union_find;
+        
+        assert(union_find.size() == 0);
+        assert(!union_find.contains("chr1"));
+        
+        union_find.union_groups("chr1", "chr2");
+        union_find.union_groups("chrX", "chrY");
+        union_find.union_groups("chr2", "chr3");
+        assert(union_find.insert("chrM") == 5);
+        assert(union_find.insert("chr1") == 0);
+        
+        assert(union_find.size() == 6);
+        assert(union_find.contains("chrX"));
+        assert(!union_find.contains("chr4"));
+        
+        assert(union_find.find_group("chr1") == union_find.find_group("chr3"));
+        assert(union_find.find_group("chr1") != union_find.find_group("chrX"));
+        assert(union_find.find_group("chrM") == "chrM");
+        assert(union_find.group_size("chr2") == 3);
+        assert(union_find.group_size("chrY") == 2);
+        
+        vector<string> group = union_find.group("chr3");
+        sort(group.begin(), group.end());
+        vector<string> correct_group {"chr1", "chr2", "chr3"};
+        assert(group == correct_group);
+        
+        assert(union_find.all_groups().size() == 3);
+    }
+    {
+        // merging new keys with a group found in the same call, while adding the new keys
+        // moves the keys in memory
+        KeyedUnionFind<string> union_find;
+        union_find.insert("chr1");
+        for (size_t i = 0; i < 100; i++) {
+            string key = "contig" + to_string(i);
+            union_find.union_groups(key, union_find.find_group("chr1"));
+            assert(union_find.find_group(key) == union_find.find_group("chr1"));
+        }
+        assert(union_find.group_size("chr1") == 101);
+    }
+    {
+        size_t num_repetitions = 100;
+        size_t num_keys = 300;
+        
+        random_device rd;
+        default_random_engine gen(rd());
+        uniform_int_distribution<uint64_t> key_distr(0, numeric_limits<uint64_t>::max());
+        uniform_int_distribution<size_t> index_distr(0, num_keys - 1);
+        
+        for (size_t repetition = 0; repetition < num_repetitions; repetition++) {
+            
+            // include structured keys as well as random ones, since the standard hash is the identity
+            vector<uint64_t> keys(num_keys);
+            for (size_t i = 0; i < num_keys; i++) {
+                keys[i] = repetition % 2 == 0 ? key_distr(gen) : i << 20;
+            }
+            
+            KeyedUnionFind<uint64_t> keyed_union_find;
+            if (repetition % 3 == 0) {
+                keyed_union_find.reserve(num_keys);
+            }
+            UnionFind union_find(num_keys);
+            
+            for (size_t i = 0; i < num_keys; i++) {
+                size_t j = index_distr(gen);
+                size_t k = index_distr(gen);
+                keyed_union_find.union_groups(keys[j], keys[k]);
+                union_find.union_groups(j, k);
+            }
+            
+            for (size_t i = 0; i < num_keys; i++) {
+                bool correct;
+                if (keyed_union_find.contains(keys[i])) {
+                    size_t j = index_distr(gen);
+                    correct = (keyed_union_find.group_size(keys[i]) == union_find.group_size(i)
+                               && (!keyed_union_find.contains(keys[j])
+                                   || ((keyed_union_find.find_group(keys[i]) == keyed_union_find.find_group(keys[j]))
+                                       == (union_find.find_group(i) == union_find.find_group(j)))));
+                }
+                else {
+                    correct = (union_find.group_size(i) == 1);
+                }
+                
+                if (!correct) {
+                    // print out the failures since their random and we might have a hard time finding them again
+                    cerr << "FAILURE: wrong keyed group of key " << keys[i] << " in repetition " << repetition << endl;
+                }
+                assert(correct);
+            }
+        }
+    }
+    
+    cerr << "All KeyedUnionFind tests successful!" << endl;
+}
+
+void test_rollback_union_find() {
+    {
+        RollbackUnionFind union_find(6);
+        
+        union_find.union_groups(0, 1);
+        size_t checkpoint_1 = union_find.checkpoint();
+        
+        union_find.union_groups(2, 3);
+        union_find.union_groups(1, 2);
+        union_find.union_groups(0, 3);
+        size_t checkpoint_2 = union_find.checkpoint();
+        
+        union_find.union_groups(4, 5);
+        union_find.union_groups(4, 0);
+        
+        assert(union_find.group_size(5) == 6);
+        
+        union_find.rollback_to(checkpoint_2);
+        
+        assert(union_find.group_size(5) == 1);
+        assert(union_find.group_size(0) == 4);
+        assert(union_find.find_group(0) == union_find.find_group(3));
+        assert(union_find.find_group(0) != union_find.find_group(4));
+        
+        union_find.rollback_to(checkpoint_1);
+        
+        assert(union_find.group_size(0) == 2);
+        assert(union_find.group_size(2) == 1);
+        assert(union_find.group_size(3) == 1);
+        assert(union_find.group_size(4) == 1);
+        assert(union_find.find_group(0) == union_find.find_group(1));
+        assert(union_find.find_group(2) != union_find.find_group(3));
+        
+        vector<size_t> group = union_find.group(1);
+        sort(group.begin(), group.end());
+        vector<size_t> correct_group {0, 1};
+        assert(group == correct_group);
+        
+        union_find.rollback_to(0);
+        for (size_t i = 0; i < union_find.size(); i++) {
+            assert(union_find.find_group(i) == i);
+            assert(union_find.group(i).size() == 1);
+        }
+    }
+    {
+        size_t num_repetitions = 100;
+        size_t num_indices = 40;
+        size_t num_steps = 200;
+        
+        random_device rd;
+        default_random_engine gen(rd());
+        uniform_int_distribution<size_t> index_distr(0, num_indices - 1);
+        uniform_int_distribution<int> action_distr(0, 9);
+        
+        for (size_t repetition = 0; repetition < num_repetitions; repetition++) {
+            
+            RollbackUnionFind union_find(num_indices);
+            
+            // replay the unions from scratch on a UnionFind to check each state
+            vector<pair<size_t, size_t>> unions;
+            vector<pair<size_t, size_t>> checkpoints;
+            
+            for (size_t step = 0; step < num_steps; step++) {
+                int action = action_distr(gen);
+                if (action < 2) {
+                    checkpoints.emplace_back(union_find.checkpoint(), unions.size());
+                }
+                else if (action < 4 && !checkpoints.empty()) {
+                    uniform_int_distribution<size_t> checkpoint_distr(0, checkpoints.size() - 1);
+                    size_t k = checkpoint_distr(gen);
+                    union_find.rollback_to(checkpoints[k].first);
+                    unions.resize(checkpoints[k].second);
+                    checkpoints.resize(k + 1);
+                }
+                else {
+                    unions.emplace_back(index_distr(gen), index_distr(gen));
+                    union_find.union_groups(unions.back().first, unions.back().second);
+                }
+                
+                UnionFind replayed(num_indices);
+                for (const pair<size_t, size_t>& idxs : unions) {
+                    replayed.union_groups(idxs.first, idxs.second);
+                }
+                for (size_t i = 0; i < num_indices; i++) {
+                    size_t j = index_distr(gen);
+                    bool correct = (union_find.group_size(i) == replayed.group_size(i)
+                                    && union_find.group(i).size() == replayed.group_size(i)
+                                    && ((union_find.find_group(i) == union_find.find_group(j))
+                                        == (replayed.find_group(i) == replayed.find_group(j))));
+                    if (!correct) {
+                        // print out the failures since their random and we might have a hard time finding them again
+                        cerr << "FAILURE: wrong rollback group of " << i << " in repetition " << repetition << " step " << step << endl;
+                    }
+                    assert(correct);
+                }
+            }
+        }
+    }
+    
+    cerr << "All RollbackUnionFind tests successful!" << endl;
+}
+
+void test_annotated_union_find() {
+    {
+        // sum of weights in each group
+        AnnotatedUnionFind<int> union_find(vector<int>{1, 2, 3, 4, 5});
+        
+        union_find.union_groups(0, 4);
+        union_find.union_groups(1, 2);
+        union_find.union_groups(4, 0);
+        
+        assert(union_find.group_annotation(0) == 6);
+        assert(union_find.group_annotation(4) == 6);
+        assert(union_find.group_annotation(2) == 5);
+        assert(union_find.group_annotation(3) == 4);
+        
+        union_find.union_groups(2, 4);
+        assert(union_find.group_annotation(1) == 11);
+        assert(union_find.group_size(1) == 4);
+        
+        union_find.annotate_group(0, 10);
+        assert(union_find.group_annotation(2) == 21);
+        assert(union_find.group_annotation(3) == 4);
+        
+        size_t i = union_find.add_element(100);
+        union_find.union_groups(i, 3);
+        assert(union_find.group_annotation(3) == 104);
+    }
+    {
+        // bounding interval of each group
+        typedef pair<int, int> Interval;
+        auto hull = [](const Interval& a, const Interval& b) {
+            return Interval(min(a.first, b.first), max(a.second, b.second));
+        };
+        AnnotatedUnionFind<Interval, function<Interval(const Interval&, const Interval&)>> union_find(0, Interval(), hull);
+        
+        for (int x : {5, -3, 8, 2, 12}) {
+            union_find.add_element(Interval(x, x));
+        }
+        
+        union_find.union_groups(0, 2);
+        union_find.union_groups(3, 1);
+        union_find.union_groups(3, 4);
+        
+        assert(union_find.group_annotation(2) == Interval(5, 8));
+        assert(union_find.group_annotation(1) == Interval(-3, 12));
+    }
+    {
+        size_t num_repetitions = 100;
+        size_t num_indices = 50;
+        
+        random_device rd;
+        default_random_engine gen(rd());
+        uniform_int_distribution<size_t> index_distr(0, num_indices - 1);
+        uniform_int_distribution<int> value_distr(-100, 100);
+        
+        for (size_t repetition = 0; repetition < num_repetitions; repetition++) {
+            
+            vector<int> values(num_indices);
+            for (int& value : values) {
+                value = value_distr(gen);
+            }
+            
+            auto minimum = [](int a, int b) { return min(a, b); };
+            AnnotatedUnionFind<int, function<int(int, int)>> union_find(values, minimum);
+            
+            for (size_t k = 0; k < num_indices; k++) {
+                union_find.union_groups(index_distr(gen), index_distr(gen));
+            }
+            
+            for (size_t i = 0; i < num_indices; i++) {
+                int group_min = numeric_limits<int>::max();
+                for (size_t j : union_find.group(i)) {
+                    group_min = min(group_min, values[j]);
+                }
+                if (union_find.group_annotation(i) != group_min) {
+                    // print out the failures since their random and we might have a hard time finding them again
+                    cerr << "FAILURE: wrong group minimum for " << i << " in repetition " << repetition << endl;
+                }
+                assert(union_find.group_annotation(i) == group_min);
+            }
+        }
+    }
+    
+    {
+        // whether any index in each group is flagged, which is stored as vector<bool>
+        AnnotatedUnionFind<bool, logical_or<bool>> union_find(4, false);
+        union_find.annotate_group(2, true);
+        assert(union_find.group_annotation(2));
+        assert(!union_find.group_annotation(0));
+        
+        union_find.union_groups(0, 1);
+        assert(!union_find.group_annotation(1));
+        union_find.union_groups(1, 2);
+        assert(union_find.group_annotation(0));
+        assert(!union_find.group_annotation(3));
+        
+        union_find.annotate_group(3, false);
+        assert(!union_find.group_annotation(3));
+        union_find.annotate_group(3, true);
+        assert(union_find.group_annotation(3));
+    }
+    
+    cerr << "All AnnotatedUnionFind tests successful!" << endl;
+}
+
+void test_weighted_union_find() {
+    {
+        WeightedUnionFind union_find(5);
+        
+        // x0 - x1 = 3, x2 - x1 = 5, x3 - x4 = -2
+        assert(union_find.union_groups(0, 1, 3));
+        assert(union_find.union_groups(2, 1, 5));
+        assert(union_find.union_groups(3, 4, -2));
+        
+        assert(union_find.diff(0, 2) == -2);
+        assert(union_find.diff(2, 0) == 2);
+        assert(union_find.diff(1, 1) == 0);
+        assert(union_find.diff(4, 3) == 2);
+        
+        // consistent and inconsistent constraints within a group
+        assert(union_find.union_groups(2, 0, 2));
+        assert(!union_find.union_groups(2, 0, 1));
+        assert(union_find.diff(2, 0) == 2);
+        
+        // x4 - x0 = 10
+        assert(union_find.union_groups(4, 0, 10));
+        assert(union_find.group_size(3) == 5);
+        assert(union_find.diff(3, 1) == 11);
+        assert(union_find.diff(3, 2) == 6);
+        assert(!union_find.union_groups(3, 1, 0));
+    }
+    {
+        size_t num_repetitions = 100;
+        size_t num_indices = 40;
+        
+        random_device rd;
+        default_random_engine gen(rd());
+        uniform_int_distribution<size_t> index_distr(0, num_indices - 1);
+        uniform_int_distribution<int64_t> value_distr(-1000, 1000);
+        
+        for (size_t repetition = 0; repetition < num_repetitions; repetition++) {
+            
+            // hidden values that all of the true constraints are drawn from
+            vector<int64_t> values(num_indices);
+            for (int64_t& value : values) {
+                value = value_distr(gen);
+            }
+            
+            WeightedUnionFind union_find(num_indices);
+            vector<size_t> labels(num_indices);
+            for (size_t i = 0; i < num_indices; i++) {
+                labels[i] = i;
+            }
+            
+            for (size_t k = 0; k < 2 * num_indices; k++) {
+                size_t i = index_distr(gen);
+                size_t j = index_distr(gen);
+                
+                if (labels[i] == labels[j]) {
+                    // the difference is already determined
+                    assert(!union_find.union_groups(i, j, values[i] - values[j] + 1));
+                    assert(union_find.union_groups(i, j, values[i] - values[j]));
+                }
+                else {
+                    assert(union_find.union_groups(i, j, values[i] - values[j]));
+                    size_t old_label = labels[j];
+                    for (size_t l = 0; l < num_indices; l++) {
+                        if (labels[l] == old_label) {
+                            labels[l] = labels[i];
+                        }
+                    }
+                }
+            }
+            
+            for (size_t i = 0; i < num_indices; i++) {
+                for (size_t j = 0; j < num_indices; j++) {
+                    if ((union_find.find_group(i) == union_find.find_group(j)) != (labels[i] == labels[j])) {
+                        // print out the failures since their random and we might have a hard time finding them again
+                        cerr << "FAILURE: wrong groups for " << i << " and " << j << " in repetition " << repetition << endl;
+                    }
+                    assert((union_find.find_group(i) == union_find.find_group(j)) == (labels[i] == labels[j]));
+                    if (labels[i] == labels[j]) {
+                        if (union_find.diff(i, j) != values[i] - values[j]) {
+                            cerr << "FAILURE: wrong difference between " << i << " and " << j << " in repetition " << repetition << endl;
+                        }
+                        assert(union_find.diff(i, j) == values[i] - values[j]);
+                    }
+                }
+            }
+        }
+    }
+    
+    cerr << "All WeightedUnionFind tests successful!" << endl;
+}
+
+void test_deletable_union_find() {
+    {
+        DeletableUnionFind union_find(6);
+        
+        union_find.union_groups(0, 1);
+        union_find.union_groups(1, 2);
+        union_find.union_groups(3, 4);
+        assert(union_find.group_size(2) == 3);
+        
+        // remove the index that currently identifies the group
+        size_t rep = union_find.find_group(0);
+        union_find.isolate(rep);
+        assert(union_find.group_size(rep) == 1);
+        assert(union_find.find_group(rep) == rep);
+        assert(union_find.group(rep) == vector<size_t>(1, rep));
+        
+        vector<size_t> rest;
+        for (size_t i = 0; i < 3; i++) {
+            if (i != rep) {
+                rest.push_back(i);
+            }
+        }
+        assert(union_find.group_size(rest[0]) == 2);
+        assert(union_find.find_group(rest[0]) == union_find.find_group(rest[1]));
+        assert(union_find.find_group(rest[0]) != rep);
+        vector<size_t> group = union_find.group(rest[1]);
+        sort(group.begin(), group.end());
+        assert(group == rest);
+        
+        // isolating a singleton does nothing
+        union_find.isolate(5);
+        assert(union_find.group_size(5) == 1);
+        
+        // an isolated index can join a group again
+        union_find.union_groups(rep, 3);
+        assert(union_find.group_size(4) == 3);
+        assert(union_find.find_group(rep) == union_find.find_group(4));
+        union_find.isolate(4);
+        union_find.isolate(3);
+        assert(union_find.group_size(rep) == 1);
+        assert(union_find.group_size(3) == 1);
+        assert(union_find.find_group(3) != union_find.find_group(4));
+    }
+    {
+        size_t num_repetitions = 100;
+        size_t num_indices = 40;
+        
+        random_device rd;
+        default_random_engine gen(rd());
+        uniform_int_distribution<size_t> index_distr(0, num_indices - 1);
+        uniform_int_distribution<int> op_distr(0, 2);
+        
+        for (size_t repetition = 0; repetition < num_repetitions; repetition++) {
+            
+            DeletableUnionFind union_find(num_indices);
+            vector<size_t> labels(num_indices);
+            for (size_t i = 0; i < num_indices; i++) {
+                labels[i] = i;
+            }
+            size_t next_label = num_indices;
+            
+            // enough operations to force several rebuilds
+            for (size_t k = 0; k < 10 * num_indices; k++) {
+                size_t i = index_distr(gen);
+                if (op_distr(gen) == 0) {
+                    union_find.isolate(i);
+                    labels[i] = next_label++;
+                }
+                else {
+                    size_t j = index_distr(gen);
+                    union_find.union_groups(i, j);
+                    size_t old_label = labels[j];
+                    for (size_t l = 0; l < num_indices; l++) {
+                        if (labels[l] == old_label) {
+                            labels[l] = labels[i];
+                        }
+                    }
+                }
+            }
+            
+            for (size_t i = 0; i < num_indices; i++) {
+                vector<size_t> expected;
+                for (size_t j = 0; j < num_indices; j++) {
+                    if ((union_find.find_group(i) == union_find.find_group(j)) != (labels[i] == labels[j])) {
+                        // print out the failures since their random and we might have a hard time finding them again
+                        cerr << "FAILURE: wrong groups for " << i << " and " << j << " in repetition " << repetition << endl;
+                    }
+                    assert((union_find.find_group(i) == union_find.find_group(j)) == (labels[i] == labels[j]));
+                    if (labels[i] == labels[j]) {
+                        expected.push_back(j);
+                    }
+                }
+                vector<size_t> group = union_find.group(i);
+                sort(group.begin(), group.end());
+                if (group != expected || union_find.group_size(i) != expected.size()) {
+                    cerr << "FAILURE: wrong members for " << i << " in repetition " << repetition << endl;
+                }
+                assert(group == expected);
+                assert(union_find.group_size(i) == expected.size());
+                assert(labels[union_find.find_group(i)] == labels[i]);
+            }
+        }
+    }
+    
+    cerr << "All DeletableUnionFind tests successful!" << endl;
+}
+
+void test_snapshot_union_find() {
+    {
+        SnapshotUnionFind union_find(6);
+        shared_ptr<const UnionFind> before = union_find.snapshot();
+        
+        union_find.union_groups(0, 1);
+        union_find.union_groups(1, 2);
+        
+        // the merges are not visible until they are published
+        assert(union_find.snapshot()->group_size_const(0) == 1);
+        assert(union_find.find_group(0) == union_find.find_group(2));
+        
+        union_find.publish();
+        shared_ptr<const UnionFind> after = union_find.snapshot();
+        assert(after->group_size_const(2) == 3);
+        assert(after->find_group_const(0) == after->find_group_const(2));
+        vector<size_t> group = after->group(1);
+        sort(group.begin(), group.end());
+        vector<size_t> correct_group {0, 1, 2};
+        assert(group == correct_group);
+        
+        // older snapshots are unaffected
+        assert(before->group_size_const(2) == 1);
+        assert(before->find_group_const(0) != before->find_group_const(2));
+        
+        size_t i = union_find.add_element();
+        union_find.union_groups(i, 5);
+        union_find.publish();
+        assert(after->size() == 6);
+        assert(union_find.snapshot()->size() == 7);
+        assert(union_find.snapshot()->group_size_const(5) == 2);
+    }
+    {
+        // readers check that the groups they see only ever grow while the writer merges
+        // the indices into one group in a random order
+        size_t num_indices = 500;
+        size_t num_readers = 3;
+        
+        random_device rd;
+        default_random_engine gen(rd());
+        vector<size_t> order(num_indices);
+        for (size_t i = 0; i < num_indices; i++) {
+            order[i] = i;
+        }
+        shuffle(order.begin(), order.end(), gen);
+        
+        SnapshotUnionFind union_find(num_indices);
+        atomic<bool> done(false);
+        atomic<bool> failed(false);
+        
+        vector<thread> readers;
+        for (size_t r = 0; r < num_readers; r++) {
+            readers.emplace_back([&]() {
+                size_t prev_size = 0;
+                while (!done.load()) {
+                    shared_ptr<const UnionFind> snapshot = union_find.snapshot();
+                    size_t size = snapshot->group_size_const(order[0]);
+                    if (size < prev_size || snapshot->group(order[0]).size() != size) {
+                        failed.store(true);
+                    }
+                    prev_size = size;
+                }
+            });
+        }
+        
+        for (size_t k = 1; k < num_indices; k++) {
+            union_find.union_groups(order[k - 1], order[k]);
+            if (k % 10 == 0) {
+                union_find.publish();
+            }
+        }
+        union_find.publish();
+        done.store(true);
+        for (thread& reader : readers) {
+            reader.join();
+        }
+        
+        if (failed.load()) {
+            // print out the failures since their random and we might have a hard time finding them again
+            cerr << "FAILURE: inconsistent snapshot seen by a reader" << endl;
+        }
+        assert(!failed.load());
+        assert(union_find.snapshot()->group_size_const(0) == num_indices);
     }
     
+    cerr << "All SnapshotUnionFind tests successful!" << endl;
+}
+
+void test_single_linkage() {
     {
-        UnionFind union_find_1(10);
-        UnionFind union_find_2(10);
-        
-        union_find_1.union_groups(0, 1);
-        union_find_1.union_groups(2, 1);
-        union_find_1.union_groups(3, 2);
-        union_find_1.union_groups(4, 5);
-        union_find_1.union_groups(7, 6);
-        union_find_1.union_groups(7, 8);
-        union_find_1.union_groups(7, 9);
-        
-        union_find_2.union_groups(0, 1);
-        union_find_2.union_groups(2, 1);
-        union_find_2.union_groups(3, 2);
-        union_find_2.union_groups(4, 5);
-        union_find_2.union_groups(7, 6);
-        union_find_2.union_groups(7, 8);
-        union_find_2.union_groups(7, 9);
+        // two triangles joined by a heavy edge, and a vertex by itself
+        vector<WeightedEdge<double>> edges {
+            {0, 1, 1.0}, {1, 2, 2.0}, {0, 2, 3.0},
+            {3, 4, 1.5}, {4, 5, 0.5}, {3, 5, 4.0},
+            {2, 3, 10.0}
+        };
+        
+        SingleLinkageClustering<double> clustering = single_linkage(7, edges);
+        
+        assert(clustering.clusters.num_groups() == 2);
+        assert(clustering.clusters.group_size(6) == 1);
+        assert(clustering.dendrogram.size() == 5);
+        
+        // leaves are clusters 0-6, and merges are clusters 7-11
+        assert(clustering.dendrogram[0].cluster_1 == 4 && clustering.dendrogram[0].cluster_2 == 5);
+        assert(clustering.dendrogram[0].size == 2);
+        assert(clustering.dendrogram[1].cluster_1 == 0 && clustering.dendrogram[1].cluster_2 == 1);
+        assert(clustering.dendrogram[2].cluster_1 == 3 && clustering.dendrogram[2].cluster_2 == 7);
+        assert(clustering.dendrogram[2].weight == 1.5);
+        assert(clustering.dendrogram[3].cluster_1 == 8 && clustering.dendrogram[3].cluster_2 == 2);
+        assert(clustering.dendrogram[3].size == 3);
+        assert(clustering.dendrogram[4].cluster_1 == 10 && clustering.dendrogram[4].cluster_2 == 9);
+        assert(clustering.dendrogram[4].size == 6);
+        assert(clustering.spanning_edges.back().weight == 10.0);
+        
+        // stop at a number of clusters
+        clustering = single_linkage(7, edges, 4);
+        assert(clustering.clusters.num_groups() == 4);
+        assert(clustering.dendrogram.size() == 3);
+        
+        // stop at a threshold
+        clustering = single_linkage(7, edges, 1, 2.0);
+        assert(clustering.clusters.num_groups() == 3);
+        assert(clustering.clusters.group_size(0) == 3);
+        assert(clustering.clusters.group_size(5) == 3);
+        
+        // infinite weights are still below the default limit
+        vector<WeightedEdge<double>> infinite_edges {{0, 1, 1.0}, {1, 2, numeric_limits<double>::infinity()}};
+        clustering = single_linkage(3, infinite_edges);
+        assert(clustering.clusters.num_groups() == 1);
+        assert(clustering.spanning_edges.back().weight == numeric_limits<double>::infinity());
+    }
+    {
+        random_device rd;
+        default_random_engine gen(rd());
         
-        assert(union_find_1.group_size(0) == union_find_2.group(0).size());
-        assert(union_find_2.group_size(0) == union_find_1.group(0).size());
-        assert(union_find_1.group_size(0) == union_find_1.group(0).size());
-        assert(union_find_2.group_size(0) == union_find_2.group(0).size());
+        // the parallel sort should agree with sort for any number of chunks
+        uniform_int_distribution<int> key_distr(0, 100);
+        vector<pair<int, size_t>> values(5000);
+        for (size_t i = 0; i < values.size(); i++) {
+            values[i] = make_pair(key_distr(gen), i);
+        }
+        vector<pair<int, size_t>> sorted = values;
+        sort(sorted.begin(), sorted.end());
+        for (size_t num_threads : {1, 2, 3, 4}) {
+            vector<pair<int, size_t>> parallel_sorted = values;
+            detail::parallel_sort(parallel_sorted.begin(), parallel_sorted.end(), less<pair<int, size_t>>(), num_threads);
+            assert(parallel_sorted == sorted);
+        }
+    }
+    {
+        size_t num_repetitions = 10;
+        size_t num_vertices = 5000;
+        // enough edges that some are partitioned and filtered rather than sorted right away
+        size_t num_edges = 100000;
         
-        assert(union_find_1.group_size(3) == union_find_2.group(3).size());
-        assert(union_find_2.group_size(3) == union_find_1.group(3).size());
-        assert(union_find_1.group_size(3) == union_find_1.group(3).size());
-        assert(union_find_2.group_size(3) == union_find_2.group(3).size());
+        random_device rd;
+        default_random_engine gen(rd());
+        uniform_int_distribution<size_t> vertex_distr(0, num_vertices - 1);
+        uniform_int_distribution<int> weight_distr(0, 1000);
+        uniform_int_distribution<size_t> num_clusters_distr(1, 10);
         
-        assert(union_find_1.group_size(9) == union_find_2.group(9).size());
-        assert(union_find_2.group_size(9) == union_find_1.group(9).size());
-        assert(union_find_1.group_size(9) == union_find_1.group(9).size());
-        assert(union_find_2.group_size(9) == union_find_2.group(9).size());
+        for (size_t repetition = 0; repetition < num_repetitions; repetition++) {
+            
+            vector<WeightedEdge<int>> edges(num_edges);
+            for (WeightedEdge<int>& edge : edges) {
+                edge = WeightedEdge<int>{vertex_distr(gen), vertex_distr(gen), weight_distr(gen)};
+            }
+            size_t num_clusters = num_clusters_distr(gen);
+            int max_weight = (repetition % 2 == 0) ? numeric_limits<int>::max() : weight_distr(gen);
+            
+            // the plain loop over sorted edges, with ties broken the same way
+            vector<WeightedEdge<int>> sorted_edges = edges;
+            sort(sorted_edges.begin(), sorted_edges.end(), [](const WeightedEdge<int>& a, const WeightedEdge<int>& b) {
+                return make_tuple(a.weight, a.first, a.second) < make_tuple(b.weight, b.first, b.second);
+            });
+            UnionFind union_find(num_vertices);
+            vector<WeightedEdge<int>> spanning_edges;
+            for (const WeightedEdge<int>& edge : sorted_edges) {
+                if (union_find.num_groups() <= num_clusters || edge.weight > max_weight) {
+                    break;
+                }
+                if (union_find.find_group(edge.first) != union_find.find_group(edge.second)) {
+                    union_find.union_groups(edge.first, edge.second);
+                    spanning_edges.push_back(edge);
+                }
+            }
+            vector<vector<size_t>> groups = union_find.all_groups();
+            sort(groups.begin(), groups.end());
+            
+            for (size_t num_threads : {1, 4}) {
+                SingleLinkageClustering<int> clustering = single_linkage(num_vertices, edges, num_clusters,
+                                                                         max_weight, num_threads);
+                
+                bool same_edges = (clustering.spanning_edges.size() == spanning_edges.size());
+                for (size_t k = 0; k < spanning_edges.size() && same_edges; k++) {
+                    same_edges = (clustering.spanning_edges[k].first == spanning_edges[k].first
+                                  && clustering.spanning_edges[k].second == spanning_edges[k].second
+                                  && clustering.spanning_edges[k].weight == spanning_edges[k].weight);
+                }
+                vector<vector<size_t>> clustering_groups = clustering.clusters.all_groups();
+                sort(clustering_groups.begin(), clustering_groups.end());
+                if (!same_edges || clustering_groups != groups) {
+                    // print out the failures since their random and we might have a hard time finding them again
+                    cerr << "FAILURE: single linkage does not match Kruskal's algorithm with " << num_threads << " threads in repetition " << repetition << endl;
+                }
+                assert(same_edges);
+                assert(clustering_groups == groups);
+                assert(clustering.dendrogram.size() == spanning_edges.size());
+                
+                // the merged clusters' sizes should add up
+                vector<size_t> cluster_sizes(num_vertices, 1);
+                for (const DendrogramMerge<int>& merge : clustering.dendrogram) {
+                    assert(merge.size == cluster_sizes[merge.cluster_1] + cluster_sizes[merge.cluster_2]);
+                    cluster_sizes.push_back(merge.size);
+                }
+            }
+        }
     }
     
-    cerr << "All curated UnionFind tests successful!" << endl;
+    cerr << "All single linkage tests successful!" << endl;
 }
 
-void test_union_find_with_random_examples() {
-    for (size_t repetition = 0; repetition < 1000; repetition++) {
+void test_concurrent_union_find_with_curated_examples() {
+    {
+        ConcurrentUnionFind union_find(10);
         
-        UnionFind union_find(30);
+        assert(union_find.size() == 10);
+        for (size_t i = 0; i < union_find.size(); i++) {
+            assert(union_find.find_group(i) == i);
+            assert(union_find.group_size(i) == 1);
+        }
         
-        vector<pair<size_t, size_t>> unions = random_unions(union_find.size());
+        union_find.union_groups(0, 1);
+        union_find.union_groups(2, 3);
+        union_find.union_groups(1, 3);
+        union_find.union_groups(0, 2);
+        union_find.union_groups(8, 9);
+        
+        assert(union_find.same_group(0, 3));
+        assert(union_find.same_group(9, 8));
+        assert(!union_find.same_group(0, 9));
+        assert(!union_find.same_group(4, 5));
+        assert(union_find.find_group(1) == union_find.find_group(2));
+        assert(union_find.group_size(3) == 4);
+        assert(union_find.group_size(8) == 2);
+        assert(union_find.group_size(5) == 1);
+    }
+    
+    cerr << "All curated ConcurrentUnionFind tests successful!" << endl;
+}
+
+void test_concurrent_union_find_with_randomized_examples() {
+    
+    size_t num_repetitions = 20;
+    size_t num_indices = 2000;
+    size_t num_unions = 1500;
+    size_t num_threads = 8;
+    
+    random_device rd;
+    default_random_engine gen(rd());
+    uniform_int_distribution<size_t> index_distr(0, num_indices - 1);
+    
+    for (size_t repetition = 0; repetition < num_repetitions; repetition++) {
         
-        vector<unordered_set<size_t>*> group_set_of(union_find.size());
-        vector<unordered_set<size_t>> group_sets(union_find.size());
-        for (size_t i = 0; i < union_find.size(); i++) {
-            group_set_of[i] = &group_sets[i];
-            group_sets[i].insert(i);
+        vector<pair<size_t, size_t>> unions;
+        for (size_t i = 0; i < num_unions; i++) {
+            unions.emplace_back(index_distr(gen), index_distr(gen));
         }
         
+        UnionFind serial_union_find(num_indices);
         for (pair<size_t, size_t> idxs : unions) {
-            union_find.union_groups(idxs.first, idxs.second);
-            
-            auto group_set_1 = group_set_of[idxs.first];
-            auto group_set_2 = group_set_of[idxs.second];
-            if (group_set_1 == group_set_2) {
-                continue;
-            }
-            for (size_t i : *group_set_2) {
-                group_set_1->insert(i);
-                group_set_of[i] = group_set_1;
-            }
-            group_set_2->clear();
+            serial_union_find.union_groups(idxs.first, idxs.second);
         }
         
-        vector<vector<size_t>> groups_direct(union_find.size());
-        vector<vector<size_t>> groups_from_all(union_find.size());
-        vector<vector<size_t>> groups_orthogonal(union_find.size());
-        // alternate the order these operations are done in just in case the
-        // internal changes during find functions affects the outcome
-        if (repetition % 2 == 0) {
-            for (size_t i = 0; i < union_find.size(); i++) {
-                groups_direct[i] = union_find.group(i);
-            }
-            
-            vector<vector<size_t>> groups = union_find.all_groups();
-            for (vector<size_t>& group : groups) {
-                for (size_t i : group) {
-                    groups_from_all[i] = group;
+        ConcurrentUnionFind union_find(num_indices);
+        
+        // each thread does a strided share of the unions and checks its own work as it goes
+        vector<thread> threads;
+        for (size_t t = 0; t < num_threads; t++) {
+            threads.emplace_back([&, t]() {
+                for (size_t k = t; k < unions.size(); k += num_threads) {
+                    union_find.union_groups(unions[k].first, unions[k].second);
+                    assert(union_find.same_group(unions[k].first, unions[k].second));
                 }
-            }
+            });
         }
-        else {
-            vector<vector<size_t>> groups = union_find.all_groups();
-            for (vector<size_t>& group : groups) {
-                for (size_t i : group) {
-                    groups_from_all[i] = group;
-                }
-            }
-            
-            for (size_t i = 0; i < union_find.size(); i++) {
-                groups_direct[i] = union_find.group(i);
-            }
+        for (thread& worker : threads) {
+            worker.join();
         }
         
-        for (size_t i = 0; i < union_find.size(); i++) {
-            vector<size_t>& group = groups_orthogonal[i];
-            for (size_t j : *group_set_of[i]) {
-                group.push_back(j);
+        for (size_t i = 0; i < num_indices; i++) {
+            bool correct = (union_find.group_size(i) == serial_union_find.group_size(i));
+            size_t j = index_distr(gen);
+            correct = correct && (union_find.same_group(i, j) == (serial_union_find.find_group(i) == serial_union_find.find_group(j)));
+            if (!correct) {
+                // print out the failures since their random and we might have a hard time finding them again
+                cerr << "FAILURE: wrong concurrent group of " << i << " in repetition " << repetition << endl;
             }
+            assert(correct);
         }
+    }
+    
+    cerr << "All randomized ConcurrentUnionFind tests successful!" << endl;
+}
+
+void test_connected_components() {
+    {
+        vector<pair<size_t, size_t>> edges {{5, 3}, {1, 4}, {3, 6}, {4, 4}};
         
-        for (size_t i = 0; i < union_find.size(); i++) {
-            
-            std::sort(groups_orthogonal[i].begin(), groups_orthogonal[i].end());
-            std::sort(groups_from_all[i].begin(), groups_from_all[i].end());
-            std::sort(groups_direct[i].begin(), groups_direct[i].end());
+        vector<size_t> labels = connected_components(8, edges);
+        vector<size_t> correct_labels {0, 1, 2, 3, 1, 3, 3, 4};
+        
+        assert(labels == correct_labels);
+        assert(connected_components(8, edges, 3) == correct_labels);
+        
+        assert(connected_components(0, vector<pair<size_t, size_t>>(), 4).empty());
+    }
+    {
+        size_t num_repetitions = 20;
+        size_t max_num_vertices = 500;
+        
+        random_device rd;
+        default_random_engine gen(rd());
+        uniform_int_distribution<size_t> num_vertices_distr(1, max_num_vertices);
+        uniform_int_distribution<size_t> num_threads_distr(1, 8);
+        
+        for (size_t repetition = 0; repetition < num_repetitions; repetition++) {
             
+            size_t num_vertices = num_vertices_distr(gen);
+            size_t num_threads = num_threads_distr(gen);
             
-            assert(union_find.group_size(i) == groups_from_all[i].size());
-            assert(union_find.group_size(i) == groups_direct[i].size());
-            assert(groups_from_all[i].size() == groups_direct[i].size());
-            assert(groups_orthogonal[i].size() == groups_direct[i].size());
+            // vary the density so that we see both sparse graphs and ones where the edges are sampled
+            uniform_int_distribution<size_t> num_edges_distr(0, 5 * num_vertices);
+            uniform_int_distribution<size_t> vertex_distr(0, num_vertices - 1);
+            vector<pair<size_t, size_t>> edges(num_edges_distr(gen));
+            for (pair<size_t, size_t>& edge : edges) {
+                edge.first = vertex_distr(gen);
+                edge.second = vertex_distr(gen);
+            }
             
-            if (!std::equal(groups_from_all[i].begin(), groups_from_all[i].end(),
-                            groups_direct[i].begin())) {
-                cerr << "FAILURE mismatch in repetition " << repetition << " in the following groups containing " << i << endl;
-                cerr << "computed directly: ";
-                for (size_t j : groups_direct[i]) {
-                    cerr << j << " ";
-                }
-                cerr << endl;
-                cerr << "computed in batch: ";
-                for (size_t j : groups_from_all[i]) {
-                    cerr << j << " ";
-                }
-                cerr << endl;
-                cerr << "groups formed by unions: ";
-                for (pair<size_t, size_t> idxs : unions) {
-                    cerr << "(" << idxs.first << "," << idxs.second << ") ";
+            UnionFind union_find(num_vertices);
+            for (const pair<size_t, size_t>& edge : edges) {
+                union_find.union_groups(edge.first, edge.second);
+            }
+            vector<size_t> correct_labels(num_vertices);
+            unordered_map<size_t, size_t> label_of_head;
+            for (size_t v = 0; v < num_vertices; v++) {
+                size_t head = union_find.find_group(v);
+                if (!label_of_head.count(head)) {
+                    size_t label = label_of_head.size();
+                    label_of_head[head] = label;
                 }
-                cerr << endl;
+                correct_labels[v] = label_of_head[head];
             }
             
-            assert(std::equal(groups_from_all[i].begin(), groups_from_all[i].end(),
-                               groups_direct[i].begin()));
-            assert(std::equal(groups_from_all[i].begin(), groups_from_all[i].end(),
-                               groups_orthogonal[i].begin()));
+            vector<size_t> labels = connected_components(num_vertices, edges, num_threads);
+            
+            if (labels != correct_labels) {
+                // print out the failures since their random and we might have a hard time finding them again
+                cerr << "FAILURE: wrong connected components with " << num_vertices << " vertices, " << edges.size() << " edges, and " << num_threads << " threads" << endl;
+            }
+            
+            assert(labels == correct_labels);
         }
     }
     
-    cerr << "All randomized UnionFind tests successful!" << endl;
+    cerr << "All connected components tests successful!" << endl;
 }
 
 void check_min_max_heap_invariants(MinMaxHeap<int>& heap, list<int>& vals) {
@@ -921,6 +2733,13 @@ void test_stable_doubles() {
         assert(abs(StableDouble(x).inverse().to_double() - 1.0 / x) < tol);
     }
     
+    // + of same-signed values where the left one is not larger, which adds in log space
+    // with the left value's log as the smaller one
+    assert(abs((StableDouble(1.0) + StableDouble(3.0)).to_double() - 4.0) < tol);
+    assert(abs((StableDouble(2.0) + StableDouble(2.0)).to_double() - 4.0) < tol);
+    assert(abs((StableDouble(-1.0) + StableDouble(-3.0)).to_double() + 4.0) < tol);
+    assert(abs((StableDouble(1e-10) + StableDouble(1.0)).to_double() - (1.0 + 1e-10)) < 1e-15);
+    
     // +
     for (double x : vals) {
         for (double y : vals) {
@@ -1307,6 +3126,191 @@ void test_rank_pairing_heap() {
     cerr << "All RankPairingHeap tests successful!" << endl;
 }
 
+vector<Run> brute_force_runs(const string& str) {
+    vector<Run> runs;
+    for (size_t p = 1; 2 * p <= str.size(); p++) {
+        size_t i = 0;
+        while (i + p < str.size()) {
+            size_t j = i;
+            while (j + p < str.size() && str[j] == str[j + p]) {
+                j++;
+            }
+            if (j - i >= p) {
+                runs.push_back(Run{i, j + p, p});
+            }
+            i = j + 1;
+        }
+    }
+    // keep only the smallest period for each interval
+    sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) {
+        return a.begin < b.begin || (a.begin == b.begin && (a.end < b.end || (a.end == b.end && a.period < b.period)));
+    });
+    vector<Run> minimal_runs;
+    for (const Run& run : runs) {
+        if (minimal_runs.empty() || minimal_runs.back().begin != run.begin || minimal_runs.back().end != run.end) {
+            minimal_runs.push_back(run);
+        }
+    }
+    return minimal_runs;
+}
+
+vector<InvertedRepeat> brute_force_inverted_repeats(const string& str, const function<char(char)>& complement,
+                                                    size_t max_spacer_length, size_t min_arm_length) {
+    // every maximal inverted repeat around every left arm end and spacer
+    vector<InvertedRepeat> candidates;
+    for (size_t i = 0; i <= str.size(); i++) {
+        for (size_t spacer = 0; spacer <= max_spacer_length && i + spacer <= str.size(); spacer++) {
+            size_t arm = 0;
+            while (arm < i && i + spacer + arm < str.size()
+                   && str[i + spacer + arm] == complement(str[i - arm - 1])) {
+                arm++;
+            }
+            if (arm >= min_arm_length && arm > 0) {
+                candidates.push_back(InvertedRepeat{i - arm, i + spacer + arm, arm});
+            }
+        }
+    }
+    // drop the ones whose pairs of characters are all paired in another one, which has the
+    // same axis, a shorter spacer, and arms that reach at least as far
+    vector<InvertedRepeat> repeats;
+    for (const InvertedRepeat& repeat : candidates) {
+        bool contained = false;
+        for (const InvertedRepeat& other : candidates) {
+            if (other.begin + other.end == repeat.begin + repeat.end
+                && other.end - other.begin - 2 * other.arm_length < repeat.end - repeat.begin - 2 * repeat.arm_length
+                && other.begin <= repeat.begin) {
+                contained = true;
+                break;
+            }
+        }
+        if (!contained) {
+            repeats.push_back(repeat);
+        }
+    }
+    return repeats;
+}
+
+// in the library's namespace so that vector comparisons can find them
+namespace structures {
+bool operator==(const Run& a, const Run& b) {
+    return a.begin == b.begin && a.end == b.end && a.period == b.period;
+}
+
+bool operator==(const InvertedRepeat& a, const InvertedRepeat& b) {
+    return a.begin == b.begin && a.end == b.end && a.arm_length == b.arm_length;
+}
+}
+
+char dna_complement(char c) {
+    switch (c) {
+        case 'A':
+            return 'T';
+        case 'C':
+            return 'G';
+        case 'G':
+            return 'C';
+        case 'T':
+            return 'A';
+        default:
+            return 'N';
+    }
+}
+
+void test_repeats_with_curated_examples() {
+    {
+        string seq = "GAAAGACACACTT";
+        
+        vector<Run> runs = find_runs(seq);
+        vector<Run> correct_runs {Run{1, 4, 1}, Run{5, 11, 2}, Run{11, 13, 1}};
+        
+        assert(runs == correct_runs);
+    }
+    {
+        string seq = "ACGACGACGAC";
+        
+        vector<Run> runs = find_runs(seq);
+        vector<Run> correct_runs {Run{0, 11, 3}};
+        
+        assert(runs == correct_runs);
+    }
+    {
+        string seq = "";
+        
+        assert(find_runs(seq).empty());
+        assert(find_palindromes(seq).empty());
+    }
+    {
+        string seq = "TACATGCC";
+        
+        vector<InvertedRepeat> palindromes = find_palindromes(seq, 2);
+        vector<InvertedRepeat> correct_palindromes {InvertedRepeat{0, 5, 2}};
+        
+        assert(palindromes == correct_palindromes);
+        
+        palindromes = find_palindromes(seq);
+        correct_palindromes = {InvertedRepeat{0, 5, 2}, InvertedRepeat{6, 8, 1}};
+        
+        assert(palindromes == correct_palindromes);
+    }
+    {
+        // a hairpin with arms GCAT and ATGC around a loop of four Cs
+        string seq = "TTGCATCCCCATGCTT";
+        
+        vector<InvertedRepeat> repeats = find_inverted_repeats(seq, dna_complement, 0, 3);
+        assert(repeats.empty());
+        
+        repeats = find_inverted_repeats(seq, dna_complement, 4, 3);
+        vector<InvertedRepeat> correct_repeats {InvertedRepeat{2, 14, 4}};
+        
+        assert(repeats == correct_repeats);
+    }
+    
+    cerr << "All curated repeat tests successful!" << endl;
+}
+
+void test_repeats_with_randomized_examples() {
+    
+    int num_strings = 300;
+    int max_str_len = 60;
+    size_t max_spacer_length = 4;
+    
+    random_device rd;
+    default_random_engine gen(rd());
+    uniform_int_distribution<int> len_distr(0, max_str_len);
+    uniform_int_distribution<size_t> arm_distr(1, 3);
+    
+    vector<string> alphabets {"AC", "ACGT"};
+    
+    for (string& alphabet : alphabets) {
+        for (int i = 0; i < num_strings; i++) {
+            
+            string str = random_string(alphabet, len_distr(gen));
+            size_t min_arm_length = arm_distr(gen);
+            
+            bool runs_correct = (find_runs(str) == brute_force_runs(str));
+            
+            auto identity = [](char c) { return c; };
+            bool palindromes_correct = (find_palindromes(str, min_arm_length)
+                                        == brute_force_inverted_repeats(str, identity, 1, min_arm_length));
+            
+            bool inverted_repeats_correct = (find_inverted_repeats(str, dna_complement, max_spacer_length, min_arm_length)
+                                             == brute_force_inverted_repeats(str, dna_complement, max_spacer_length,
+                                                                             min_arm_length));
+            
+            if (!runs_correct || !palindromes_correct || !inverted_repeats_correct) {
+                // print out the failures since their random and we might have a hard time finding them again
+                cerr << "FAILURE: wrong repeats on " << str << " with minimum arm length " << min_arm_length << endl;
+            }
+            
+            assert(runs_correct);
+            assert(palindromes_correct);
+            assert(inverted_repeats_correct);
+        }
+    }
+    
+    cerr << "All randomized repeat tests successful!" << endl;
+}
+
 int main(void) {
     test_stable_doubles();
     test_immutable_list();
@@ -1315,6 +3319,21 @@ int main(void) {
     test_updateable_priority_queue();
     test_union_find_with_curated_examples();
     test_union_find_with_random_examples();
+    test_basic_union_find();
+    test_keyed_union_find();
+    test_rollback_union_find();
+    test_annotated_union_find();
+    test_weighted_union_find();
+    test_deletable_union_find();
+    test_snapshot_union_find();
+    test_concurrent_union_find_with_curated_examples();
+    test_concurrent_union_find_with_randomized_examples();
+    test_connected_components();
+    test_single_linkage();
     test_suffix_tree_with_curated_examples();
     test_suffix_tree_with_randomized_examples();
+    test_sliding_suffix_tree_with_curated_examples();
+    test_sliding_suffix_tree_with_randomized_examples();
+    test_repeats_with_curated_examples();
+    test_repeats_with_randomized_examples();
 }
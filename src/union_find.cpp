@@ -15,115 +15,95 @@
 // specific language governing permissions and limitations
 // under the License.
 
+
 #include "structures/union_find.hpp"
 
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
 namespace structures {
 
 using namespace std;
 
-struct UnionFind::UFNode {
-    UFNode(size_t index) : rank(0), size(1), head(index) {}
-    ~UFNode() {}
-    
-    size_t rank;
-    size_t size;
-    size_t head;
-    unordered_set<size_t> children;
-};
+namespace detail {
 
-UnionFind::UnionFind(size_t size) {
-    uf_nodes.reserve(size);
-    for (size_t i = 0; i < size; i++) {
-        uf_nodes.emplace_back(i);
+void parallel_chunks(size_t size, size_t num_threads,
+                     const function<void(size_t, size_t, size_t)>& process_chunk) {
+    if (num_threads <= 1) {
+        process_chunk(0, 0, size);
+        return;
     }
-}
-
-UnionFind::~UnionFind() {
-    // nothing to do
-}
-
-size_t UnionFind::size() {
-    return uf_nodes.size();
-}
-
-size_t UnionFind::find_group(size_t i) {
-    vector<size_t> path;
-    // traverse tree upwards
-    while (uf_nodes[i].head != i) {
-        path.push_back(i);
-        i = uf_nodes[i].head;
+    vector<thread> threads;
+    for (size_t t = 0; t < num_threads; t++) {
+        threads.emplace_back(process_chunk, t, (size * t) / num_threads, (size * (t + 1)) / num_threads);
     }
-    // compress path
-    unordered_set<size_t>& head_children = uf_nodes[i].children;
-    for (size_t p = 1; p < path.size(); p++) {
-        size_t j = path[p - 1];
-        uf_nodes[j].head = i;
-        uf_nodes[path[p]].children.erase(j);
-        head_children.insert(j);
+    for (thread& worker : threads) {
+        worker.join();
     }
-    // note: don't need to compress path for the final index since it
-    // already points to the head
-    return i;
 }
 
-void UnionFind::union_groups(size_t i, size_t j) {
-    size_t head_i = find_group(i);
-    size_t head_j = find_group(j);
-    if (head_i == head_j) {
-        // the indices are already in the same group
-        return;
+bool write_blocks(const string& path, const vector<pair<const void*, size_t>>& blocks) {
+    // write to a new file in the same directory, so that a mapping of the old file keeps
+    // its contents, and then move it into place
+    static atomic<size_t> num_temp_files(0);
+    string temp_path = path + ".tmp." + to_string(getpid()) + "." + to_string(num_temp_files++);
+    int fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+    if (fd < 0) {
+        return false;
     }
-    else {
-        // use rank as a pivot to determine which group to make the head
-        UFNode& node_i = uf_nodes[head_i];
-        UFNode& node_j = uf_nodes[head_j];
-        if (node_i.rank > node_j.rank) {
-            node_j.head = head_i;
-            node_i.children.insert(head_j);
-            node_i.size += node_j.size;
-        }
-        else {
-            node_i.head = head_j;
-            node_j.children.insert(head_i);
-            node_j.size += node_i.size;
-            
-            if (node_j.rank == node_i.rank) {
-                node_j.rank++;
+    bool success = true;
+    for (const pair<const void*, size_t>& block : blocks) {
+        const char* bytes = reinterpret_cast<const char*>(block.first);
+        size_t remaining = block.second;
+        while (success && remaining > 0) {
+            ssize_t written = write(fd, bytes, remaining);
+            if (written > 0) {
+                bytes += written;
+                remaining -= written;
+            }
+            else if (written == 0 || errno != EINTR) {
+                success = false;
             }
         }
     }
+    success = (close(fd) == 0) && success;
+    if (success) {
+        success = (rename(temp_path.c_str(), path.c_str()) == 0);
+    }
+    if (!success) {
+        unlink(temp_path.c_str());
+    }
+    return success;
 }
 
-size_t UnionFind::group_size(size_t i) {
-    return uf_nodes[find_group(i)].size;
-}
-
-vector<size_t> UnionFind::group(size_t i) {
-    vector<size_t> to_return;
-    // go to head of group
-    vector<size_t> stack{find_group(i)};
-    // traverse tree downwards to find all indices in group
-    while (!stack.empty()) {
-        size_t curr = stack.back();
-        stack.pop_back();
-        to_return.push_back(curr);
-        unordered_set<size_t>& children = uf_nodes[curr].children;
-        for (size_t child : children) {
-            stack.push_back(child);
-        }
+shared_ptr<void> map_file_private(const string& path, size_t& file_size) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return shared_ptr<void>();
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        close(fd);
+        return shared_ptr<void>();
     }
-    return to_return;
+    size_t mapped_size = file_stat.st_size;
+    void* mapped = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return shared_ptr<void>();
+    }
+    file_size = mapped_size;
+    return shared_ptr<void>(mapped, [mapped_size](void* address) { munmap(address, mapped_size); });
 }
 
-vector<vector<size_t>> UnionFind::all_groups() {
-    vector<vector<size_t>> to_return(uf_nodes.size());
-    for (size_t i = 0; i < uf_nodes.size(); i++) {
-        to_return[find_group(i)].push_back(i);
-    }
-    auto new_end = std::remove_if(to_return.begin(), to_return.end(),
-                                  [](const vector<size_t>& grp) { return grp.empty(); });
-    to_return.resize(new_end - to_return.begin());
-    return to_return;
 }
 
 }
@@ -0,0 +1,104 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "structures/weighted_union_find.hpp"
+
+#include <cassert>
+#include <algorithm>
+
+namespace structures {
+
+using namespace std;
+
+WeightedUnionFind::WeightedUnionFind(size_t size) : parents(size), offsets(size, 0), ranks(size, 0),
+                                                    sizes(size, 1) {
+    for (size_t i = 0; i < size; i++) {
+        parents[i] = i;
+    }
+}
+
+WeightedUnionFind::~WeightedUnionFind() {
+    // nothing to do
+}
+
+size_t WeightedUnionFind::size() const {
+    return parents.size();
+}
+
+size_t WeightedUnionFind::find_group(size_t i) {
+    // find the head and the offset of index i from it
+    size_t head = i;
+    int64_t remaining = 0;
+    while (parents[head] != head) {
+        remaining += offsets[head];
+        head = parents[head];
+    }
+    // point the path at the head, peeling off each index's old offset as we pass it
+    while (parents[i] != head && i != head) {
+        size_t next = parents[i];
+        int64_t offset = offsets[i];
+        parents[i] = head;
+        offsets[i] = remaining;
+        remaining -= offset;
+        i = next;
+    }
+    return head;
+}
+
+bool WeightedUnionFind::union_groups(size_t i, size_t j, int64_t difference) {
+    size_t head_i = find_group(i);
+    size_t head_j = find_group(j);
+    // after the finds, the offsets of i and j are measured from their heads
+    int64_t offset_i = (i == head_i) ? 0 : offsets[i];
+    int64_t offset_j = (j == head_j) ? 0 : offsets[j];
+    if (head_i == head_j) {
+        // the constraint is either redundant or contradictory
+        return offset_i - offset_j == difference;
+    }
+    
+    // x_head_i - x_head_j, derived from x_i - x_j = difference
+    int64_t head_difference = difference - offset_i + offset_j;
+    
+    // use rank as a pivot to determine which group to make the head
+    if (ranks[head_i] > ranks[head_j]) {
+        swap(head_i, head_j);
+        head_difference = -head_difference;
+    }
+    parents[head_i] = head_j;
+    offsets[head_i] = head_difference;
+    sizes[head_j] += sizes[head_i];
+    if (ranks[head_i] == ranks[head_j]) {
+        ranks[head_j]++;
+    }
+    return true;
+}
+
+int64_t WeightedUnionFind::diff(size_t i, size_t j) {
+    size_t head_i = find_group(i);
+    size_t head_j = find_group(j);
+    assert(head_i == head_j);
+    int64_t offset_i = (i == head_i) ? 0 : offsets[i];
+    int64_t offset_j = (j == head_j) ? 0 : offsets[j];
+    return offset_i - offset_j;
+}
+
+size_t WeightedUnionFind::group_size(size_t i) {
+    return sizes[find_group(i)];
+}
+
+}